@@ -1,7 +1,10 @@
 #include "Actor.h"
 #include "GameConstants.h"
 #include "StudentWorld.h"
+#include "Metrics.h"
+#include "StateHash.h"
 #include <vector>
+#include <algorithm>
 using namespace std;
 
 // ACTOR IMPLEMENTATION
@@ -11,9 +14,16 @@ Actor::Actor(StudentWorld* world, int imageID, int startX, int startY, int dir,
 {
     m_alive = true;
     m_world = world;
-    
-    m_activatedOnPeach = false;
-    m_activatedOnYoshi = false;
+    m_actorSlot = -1;
+    m_asleep = false;
+    m_wakeTick = 0;
+    m_sleepCell = -1;
+    m_coastFrom = -1;
+    m_activatedPlayers = 0;
+    m_aliveMetric = -1;
+    m_actorID = world->newActorID();
+    m_stateHash = stateKey(hash_position, m_actorID, packPosition(startX, startY));
+    Metrics::add(metric_actor_allocations);
 }
 
 void Actor::hitByVortex()
@@ -32,7 +42,64 @@ bool Actor::isAlive() const
 
 void Actor::setDead()
 {
+    if (!m_alive)
+        return;
     m_alive = false;
+    m_world->buryActor(this);
+}
+
+bool Actor::retire()
+{
+    return false;
+}
+
+void Actor::revive()
+{
+    m_alive = true;
+}
+
+void Actor::moveTo(int x, int y)
+{
+    if (x != getX() || y != getY())
+        rehash(stateKey(hash_position, m_actorID, packPosition(getX(), getY())) ^
+               stateKey(hash_position, m_actorID, packPosition(x, y)));
+    GraphObject::moveTo(x, y);
+}
+
+int Actor::getActorID() const
+{
+    return m_actorID;
+}
+
+uint64_t Actor::getStateHash() const
+{
+    return m_stateHash;
+}
+
+void Actor::rehash(uint64_t change)
+{
+    m_stateHash ^= change;
+    if (m_actorSlot >= 0)
+        m_world->changeStateHash(change);
+}
+
+int Actor::idleTicks() const
+{
+    return 0;
+}
+
+bool Actor::watchesPlayers() const
+{
+    return false;
+}
+
+int Actor::coastTicks() const
+{
+    return 0;
+}
+
+void Actor::coast(int numTicks)
+{
 }
 
 bool Actor::sharesCoordsWith(Actor* otherActor) const
@@ -51,60 +118,44 @@ bool Actor::overlapsWith(Actor* otherActor) const
 
 bool Actor::getActivation(int playerNum)
 {
-    if (playerNum == 1)
-        return m_activatedOnPeach;
-    return m_activatedOnYoshi;
+    return (m_activatedPlayers >> (playerNum - 1)) & 1;
 }
 
 void Actor::changeActivation(int playerNum, bool status)
 {
-    if (playerNum == 1)
-        m_activatedOnPeach = status;
+    uint64_t bit = uint64_t(1) << (playerNum - 1);
+    if (status)
+        m_activatedPlayers |= bit;
     else
-        m_activatedOnYoshi = status;
+        m_activatedPlayers &= ~bit;
 }
 
-// mustLand of 1 means player must not be in the walking state for activity to occur
-// mustLand of 2 means player can be in either the walking state or the waiting to roll state for the activity to occur
-// mustland of 3 means different activities occur depending on state of player
-void Actor::activateOnPlayers(int mustLand)
+// Enemies act on a player who has landed on them, once per visit.  Only the
+// players standing in this cell are looked at, however many are playing.
+void Actor::activateOnLandedPlayers()
 {
-    for (int playerNum = 1; playerNum <= 2; playerNum++)
+    uint64_t here = getWorld()->getPlayersAt(getX(), getY());
+    m_activatedPlayers &= here;
+    uint64_t arrived = here & ~m_activatedPlayers;
+    for (int playerNum = 1; arrived != 0; playerNum++, arrived >>= 1)
     {
-        Player* player = (playerNum == 1) ? getWorld()->getPeach() : getWorld()->getYoshi();
-        if (!sharesCoordsWith(player))
-            changeActivation(playerNum, false);
-        if (sharesCoordsWith(player) && !getActivation(playerNum))
+        if (!(arrived & 1))
+            continue;
+        Player* player = getWorld()->getPlayer(playerNum);
+        if (!player->isWalking())
         {
-            if (mustLand == 1 || mustLand == 3)
-            {
-                if (!player->isWalking())
-                {
-                    doActivity(player);
-                    changeActivation(playerNum, true);
-                }
-                // If player is in the walking state and mustLand is 3...
-                else if (mustLand == 3)
-                {
-                    // Do secondary activity (relevant for BankSquare)
-                    doActivity2(player);
-                    changeActivation(playerNum, true);
-                }
-            }
-            else if (mustLand == 2)
-            {
-                doActivity(player);
-                changeActivation(playerNum, true);
-            }
+            doActivity(player);
+            changeActivation(playerNum, true);
         }
     }
 }
 
-void Actor::doActivity(Player* player)
+bool Actor::hasPlayersToActivate() const
 {
+    return (getWorld()->getPlayersAt(getX(), getY()) & ~m_activatedPlayers) != 0;
 }
 
-void Actor::doActivity2(Player* player)
+void Actor::doActivity(Player* player)
 {
 }
 
@@ -113,34 +164,60 @@ void Actor::doActivity2(Player* player)
 Mover::Mover(StudentWorld* world, int imageID, int startX, int startY)
  : Actor(world, imageID, startX, startY)
 {
-    m_walking = false;
-    m_walkDir = right;
-    m_ticksToMove = 0;
+    m_slot = world->getMovers().add(this, startX, startY);
+    setWalkDir(right);
 }
 
-bool Mover::isSquare() const
+Mover::~Mover()
 {
-    return false;
+    if (m_slot >= 0)
+        store().remove(m_slot);
+}
+
+void Mover::leaveStore()
+{
+    store().remove(m_slot);
+    m_slot = -1;
+}
+
+void Mover::joinStore(int x, int y)
+{
+    m_slot = store().add(this, x, y);
+}
+
+// Changing where or how a mover walks wakes it if it was asleep
+
+void Mover::moveTo(int x, int y)
+{
+    getWorld()->wakeActor(this);
+    store().x[m_slot] = x;
+    store().y[m_slot] = y;
+    Actor::moveTo(x, y);
 }
 
 bool Mover::isWalking() const
 {
-    return m_walking;
+    return store().walking[m_slot];
 }
 
 void Mover::setWalking(bool walking)
 {
-    m_walking = walking;
+    getWorld()->wakeActor(this);
+    store().walking[m_slot] = walking;
 }
 
 int Mover::getWalkDir() const
 {
-    return m_walkDir;
+    return store().walkDir[m_slot];
 }
 
 void Mover::setWalkDir(int dir)
 {
-    m_walkDir = dir;
+    MoverStore& movers = store();
+    getWorld()->wakeActor(this);
+    movers.walkDir[m_slot] = dir;
+    movers.dx[m_slot] = (dir == right) ? 2 : (dir == left) ? -2 : 0;
+    movers.dy[m_slot] = (dir == up) ? 2 : (dir == down) ? -2 : 0;
     if (dir == left)
         setDirection(left);
     else
@@ -195,53 +272,104 @@ int Mover::chooseRandomDir() const
         if (canGoInDir(dirs[i]))
             validDirs.push_back(dirs[i]);
     }
+    // A square with no neighbors (see boardcheck) leaves nowhere to go
+    if (validDirs.empty())
+        return getWalkDir();
     return validDirs[randInt(0, static_cast<int>(validDirs.size()) - 1)];
 }
 
 int Mover::getTicks() const
 {
-    return m_ticksToMove;
+    return store().ticks[m_slot];
 }
 
 void Mover::changeTicks(int ticks)
 {
-    m_ticksToMove += ticks;
+    store().ticks[m_slot] += ticks;
 }
 
 void Mover::swap(Mover* otherMover)
 {
+    getWorld()->wakeActor(this);
+    getWorld()->wakeActor(otherMover);
     int tempX = getX();
     int tempY = getY();
-    int tempWalking = m_walking;
-    int tempTicks = m_ticksToMove;
-    int tempWalkDir = m_walkDir;
+    bool tempWalking = isWalking();
+    int tempTicks = getTicks();
+    int tempWalkDir = getWalkDir();
     int tempDir = getDirection();
     moveTo(otherMover->getX(), otherMover->getY());
-    m_walking = otherMover->m_walking;
-    m_ticksToMove = otherMover->m_ticksToMove;
-    m_walkDir = otherMover->m_walkDir;
+    setWalking(otherMover->isWalking());
+    changeTicks(otherMover->getTicks() - tempTicks);
+    setWalkDir(otherMover->getWalkDir());
     setDirection(otherMover->getDirection());
     otherMover->moveTo(tempX, tempY);
-    otherMover->m_walking = tempWalking;
-    otherMover->m_ticksToMove = tempTicks;
-    otherMover->m_walkDir = tempWalkDir;
+    otherMover->setWalking(tempWalking);
+    otherMover->changeTicks(tempTicks - otherMover->getTicks());
+    otherMover->setWalkDir(tempWalkDir);
     otherMover->setDirection(tempDir);
 }
 
 void Mover::teleport()
 {
-    Actor* randSquare = getWorld()->chooseRandomSquare();
-    moveTo(randSquare->getX(), randSquare->getY());
+    int squareX, squareY;
+    getWorld()->chooseRandomSquare(squareX, squareY);
+    moveTo(squareX, squareY);
+}
+
+void Mover::requestStep()
+{
+    store().stepping[m_slot] = 1;
+}
+
+// Shows the position the batch step left in the store
+void Mover::finishStep()
+{
+    Actor::moveTo(store().x[m_slot], store().y[m_slot]);
+}
+
+void Mover::coast(int numTicks)
+{
+    MoverStore& movers = store();
+    movers.x[m_slot] += movers.dx[m_slot] * numTicks;
+    movers.y[m_slot] += movers.dy[m_slot] * numTicks;
+    movers.ticks[m_slot] -= numTicks;
+    Actor::moveTo(movers.x[m_slot], movers.y[m_slot]);
+}
+
+int Mover::stepsToNextSquare() const
+{
+    const MoverStore& movers = store();
+    int step = movers.dx[m_slot] + movers.dy[m_slot];
+    // Enemies can wander off the board, so positions may be negative
+    int position = (movers.dx[m_slot] != 0) ? movers.x[m_slot] : movers.y[m_slot];
+    int offset = ((position % SPRITE_WIDTH) + SPRITE_WIDTH) % SPRITE_WIDTH;
+    int pixels = (step > 0) ? SPRITE_WIDTH - offset : (offset == 0 ? SPRITE_WIDTH : offset);
+    int steps = pixels / 2;
+    if (step == 0 || movers.ticks[m_slot] < steps)
+        return 0;
+    return steps;
+}
+
+MoverStore& Mover::store() const
+{
+    return getWorld()->getMovers();
+}
+
+int Mover::slot() const
+{
+    return m_slot;
 }
 
 // PLAYER IMPLEMENTATION
 
 Player::Player(StudentWorld* world, int startX, int startY, int playerNum)
- : Mover(world, (playerNum == 1) ? IID_PEACH : IID_YOSHI, startX, startY)
+ : Mover(world, (playerNum % 2 == 1) ? IID_PEACH : IID_YOSHI, startX, startY)
 {
     m_playerNum = playerNum;
     m_stars = 0;
     m_coins = 0;
+    rehash(stateKey(hash_coins, getActorID(), 0) ^ stateKey(hash_stars, getActorID(), 0));
     m_hasVortex = false;
     m_justLanded = true;
     m_transported = true;
@@ -331,17 +459,17 @@ void Player::doSomething()
         }
         m_directedBySquare = false;
         
-        // Move 2 pixels in the walk direction
-        moveAtAngle(getWalkDir(), 2);
-        
-        // Decrement ticks left
-        changeTicks(-1);
-        
-        if (getTicks() == 0)
-        {
-            setWalking(false);
-            m_justLanded = true;
-        }
+        // Move 2 pixels in the walk direction and use up a tick
+        requestStep();
+    }
+}
+
+void Player::afterStep()
+{
+    if (getTicks() == 0)
+    {
+        setWalking(false);
+        m_justLanded = true;
     }
 }
 
@@ -350,12 +478,39 @@ bool Player::canGetHitByVortex() const
     return false;
 }
 
+// A player that didn't step and has no input waiting would do nothing again
+int Player::idleTicks() const
+{
+    if (store().stepping[slot()] || getWorld()->hasPendingAction(m_playerNum))
+        return 0;
+    return -1;
+}
+
+// Once a player has stepped off toward the next square it only acts again on
+// arriving there, unless a vortex in flight needs its exact position
+int Player::coastTicks() const
+{
+    if (!store().stepping[slot()] || m_directedBySquare || getWorld()->vortexInFlight())
+        return 0;
+    return max(stepsToNextSquare() - 2, 0);
+}
+
 void Player::teleport()
 {
     Mover::teleport();
     // Set random new valid walk direction
     setWalkDir(chooseRandomDir());
-    cerr << "Current random dir: " << getWalkDir() << endl;
+    worldLog("Current random dir: ", getWalkDir(), "\n");
+}
+
+const char* Player::typeName() const
+{
+    return "player";
+}
+
+int Player::getPlayerNum() const
+{
+    return m_playerNum;
 }
 
 void Player::setDirectedBySquare()
@@ -384,22 +539,28 @@ int Player::changeCoins(int coins)
     if (m_coins + coins < 0)
     {
         coinsAdded = -m_coins;
-        m_coins = 0;
+        setCoins(0);
     }
     else
     {
         coinsAdded = coins;
-        m_coins += coins;
+        setCoins(m_coins + coins);
     }
-    cerr << m_coins << ", " << coinsAdded << " added" << endl;
+    worldLog(m_coins, ", ", coinsAdded, " added\n");
     return coinsAdded;
 }
 
 void Player::swapCoins(Player* otherPlayer)
 {
     int tempCoins = m_coins;
-    m_coins = otherPlayer->m_coins;
-    otherPlayer->m_coins = tempCoins;
+    setCoins(otherPlayer->m_coins);
+    otherPlayer->setCoins(tempCoins);
+}
+
+void Player::setCoins(int coins)
+{
+    rehash(stateKey(hash_coins, getActorID(), m_coins) ^ stateKey(hash_coins, getActorID(), coins));
+    m_coins = coins;
 }
 
 int Player::getStars() const
@@ -413,22 +574,28 @@ int Player::changeStars(int stars)
     if (m_stars + stars < 0)
     {
         starsAdded = -m_stars;
-        m_stars = 0;
+        setStars(0);
     }
     else
     {
         starsAdded = stars;
-        m_stars += stars;
+        setStars(m_stars + stars);
     }
-    cerr << m_stars << ", " << starsAdded << " added" << endl;
+    worldLog(m_stars, ", ", starsAdded, " added\n");
     return starsAdded;
 }
 
 void Player::swapStars(Player* otherPlayer)
 {
     int tempStars = m_stars;
-    m_stars = otherPlayer->m_stars;
-    otherPlayer->m_stars = tempStars;
+    setStars(otherPlayer->m_stars);
+    otherPlayer->setStars(tempStars);
+}
+
+void Player::setStars(int stars)
+{
+    rehash(stateKey(hash_stars, getActorID(), m_stars) ^ stateKey(hash_stars, getActorID(), stars));
+    m_stars = stars;
 }
 
 bool Player::hasVortex() const
@@ -453,10 +620,14 @@ void Vortex::doSomething()
 {
     if (!isAlive())
         return;
-    moveAtAngle(getWalkDir(), 2);
+    requestStep();
+}
+
+void Vortex::afterStep()
+{
     if (getX() < 0 || getX() >= VIEW_WIDTH || getY() < 0 || getY() >= VIEW_HEIGHT)
     {
-        cerr << "Passed screen boundaries\n";
+        worldLog("Passed screen boundaries\n");
         setDead();
     }
     if (getWorld()->checkVortexOverlap(this))
@@ -471,20 +642,48 @@ bool Vortex::canGetHitByVortex() const
     return false;
 }
 
+const char* Vortex::typeName() const
+{
+    return "vortex";
+}
+
+bool Vortex::retire()
+{
+    leaveStore();
+    setVisible(false);
+    return true;
+}
+
+void Vortex::relaunch(int startX, int startY, int dir)
+{
+    joinStore(startX, startY);
+    moveTo(startX, startY);
+    setWalkDir(dir);
+    setVisible(true);
+    revive();
+}
+
 // ENEMY IMPLEMENTATION
 
 Enemy::Enemy(StudentWorld* world, int imageID, int startX, int startY, int maxSquares)
  : Mover(world, imageID, startX, startY)
 {
-    m_pauseCounter = 180;
+    changePauseCounter(180);
     m_maxSquaresToMove = maxSquares;
+    m_pausedThrough = world->getTickCount();
 }
 
 void Enemy::doSomething()
 {
+    // Count off the ticks slept through since the enemy last acted
+    long long now = getWorld()->getTickCount();
+    if (!isWalking())
+        changePauseCounter(-static_cast<int>(now - 1 - m_pausedThrough));
+    m_pausedThrough = now;
+    
     if (!isWalking())
     {
-        activateOnPlayers(1);
+        activateOnLandedPlayers();
         changePauseCounter(-1);
         if (getPauseCounter() == 0)
         {
@@ -503,18 +702,18 @@ void Enemy::doSomething()
             // Set new walk direction
             setAutomaticWalkDir();
         
-        // Move 2 pixels in the walk direction
-        moveAtAngle(getWalkDir(), 2);
-        
-        // Decrement ticks left
-        changeTicks(-1);
-        
-        if (getTicks() == 0)
-        {
-            setWalking(false);
-            changePauseCounter(180);
-            doWalkingActivity();
-        }
+        // Move 2 pixels in the walk direction and use up a tick
+        requestStep();
+    }
+}
+
+void Enemy::afterStep()
+{
+    if (getTicks() == 0)
+    {
+        setWalking(false);
+        changePauseCounter(180);
+        doWalkingActivity();
     }
 }
 
@@ -523,9 +722,33 @@ bool Enemy::canGetHitByVortex() const
     return true;
 }
 
+// A paused enemy sleeps until its pause runs out, unless a player it hasn't
+// acted on yet is on its cell
+int Enemy::idleTicks() const
+{
+    if (isWalking() || getPauseCounter() <= 1)
+        return 0;
+    if (hasPlayersToActivate())
+        return 0;
+    return getPauseCounter() - 1;
+}
+
+bool Enemy::watchesPlayers() const
+{
+    return true;
+}
+
+int Enemy::coastTicks() const
+{
+    if (!store().stepping[slot()] || getWorld()->vortexInFlight())
+        return 0;
+    return max(stepsToNextSquare() - 2, 0);
+}
+
 void Enemy::hitByVortex()
 {
-    cerr << "Actor was hit by vortex\n";
+    worldLog("Actor was hit by vortex\n");
+    m_pausedThrough = getWorld()->getTickCount();
     setWalking(false);
     setWalkDir(right);
     changePauseCounter(-getPauseCounter() + 180);
@@ -534,12 +757,12 @@ void Enemy::hitByVortex()
 
 int Enemy::getPauseCounter() const
 {
-    return m_pauseCounter;
+    return store().pause[slot()];
 }
 
 void Enemy::changePauseCounter(int pauses)
 {
-    m_pauseCounter += pauses;
+    store().pause[slot()] += pauses;
 }
 
 void Enemy::doWalkingActivity()
@@ -553,15 +776,22 @@ Bowser::Bowser(StudentWorld* world, int startX, int startY)
 {
 }
 
+const char* Bowser::typeName() const
+{
+    return "bowser";
+}
+
 void Bowser::doActivity(Player* player)
 {
     int lose = randInt(0, 1);
     if (lose == 1)
     {
-        player->changeStars(-player->getStars());
-        player->changeCoins(-player->getCoins());
+        int stars = player->changeStars(-player->getStars());
+        int coins = player->changeCoins(-player->getCoins());
+        getWorld()->logEconomy(econ_bowser_robbery, player, getX(), getY(), coins, stars);
         getWorld()->playSound(SOUND_BOWSER_ACTIVATE);
-        cerr << "Bowser robbed " << ((player == getWorld()->getPeach()) ? "Peach" : "Yoshi") << "\n";
+        getWorld()->countHeat(heat_bowser_robbery, getX(), getY());
+        worldLog("Bowser robbed player ", player->getPlayerNum(), "\n");
     }
 }
 
@@ -583,187 +813,174 @@ Boo::Boo(StudentWorld* world, int startX, int startY)
 {
 }
 
+const char* Boo::typeName() const
+{
+    return "boo";
+}
+
 void Boo::doActivity(Player* player)
 {
     int swapItem = randInt(0, 1);
+    Player* otherPlayer = getWorld()->getOtherPlayer(player);
     if (swapItem == 0)
     {
-        player->swapCoins(getWorld()->getOtherPlayer(player));
-        cerr << "Boo swapped coins\n";
+        int coins = otherPlayer->getCoins() - player->getCoins();
+        player->swapCoins(otherPlayer);
+        getWorld()->logEconomy(econ_boo_coin_swap, player, getX(), getY(), coins, 0, 0, otherPlayer);
+        worldLog("Boo swapped coins\n");
     }
     else
     {
-        player->swapStars(getWorld()->getOtherPlayer(player));
-        cerr << "Boo swapped stars\n";
+        int stars = otherPlayer->getStars() - player->getStars();
+        player->swapStars(otherPlayer);
+        getWorld()->logEconomy(econ_boo_star_swap, player, getX(), getY(), 0, stars, 0, otherPlayer);
+        worldLog("Boo swapped stars\n");
     }
     getWorld()->playSound(SOUND_BOO_ACTIVATE);
+    getWorld()->countHeat(heat_boo_swap, getX(), getY());
 }
 
 // SQUARE IMPLEMENTATION
 
-Square::Square(StudentWorld* world, int imageID, int startX, int startY, int mustLand, int dir)
- : Actor(world, imageID, startX, startY, dir, 1)
-{
-    m_mustLand = mustLand;
-}
-
-void Square::doSomething()
-{
-    activateOnPlayers(m_mustLand);
-}
-
-bool Square::isSquare() const
+int squareImageID(const Square& square)
 {
-    return true;
-}
-
-bool Square::canGetHitByVortex() const
-{
-    return false;
-}
-
-// COIN SQUARE IMPLEMENTATION
-
-CoinSquare::CoinSquare(StudentWorld* world, int startX, int startY, bool grant)
- : Square(world, (grant == true) ? IID_BLUE_COIN_SQUARE : IID_RED_COIN_SQUARE, startX, startY, 1)
-{
-    m_grant = grant;
-}
- 
-void CoinSquare::doActivity(Player* player)
-{
-    int numCoins;
-    int sound;
-    
-    if (m_grant)
-    {
-        numCoins = 3;
-        sound = SOUND_GIVE_COIN;
-    }
-    else
+    switch (square.kind)
     {
-        numCoins = -3;
-        sound = SOUND_TAKE_COIN;
+        case coin_square:
+            return (square.coins > 0) ? IID_BLUE_COIN_SQUARE : IID_RED_COIN_SQUARE;
+        case star_square:
+            return IID_STAR_SQUARE;
+        case dir_square:
+            return IID_DIR_SQUARE;
+        case bank_square:
+            return IID_BANK_SQUARE;
+        case event_square:
+            return IID_EVENT_SQUARE;
+        default:
+            return IID_DROPPING_SQUARE;
     }
-    cerr << "Coins: ";
-    player->changeCoins(numCoins);
-    getWorld()->playSound(sound);
 }
 
-// STAR SQUARE IMPLEMENTATION
-
-StarSquare::StarSquare(StudentWorld* world, int startX, int startY)
- : Square(world, IID_STAR_SQUARE, startX, startY, 2)
-{
-}
-
-void StarSquare::doActivity(Player* player)
+bool activateSquare(StudentWorld* world, const Square& square, Player* player)
 {
-    if (player->getCoins() >= 20)
+    bool walking = player->isWalking();
+    switch (square.kind)
     {
-        cerr << "Coins: ";
-        player->changeCoins(-20);
-        
-        cerr << "Stars: ";
-        player->changeStars(1);
-        
-        getWorld()->playSound(SOUND_GIVE_STAR);
-    }
-}
-
-// DIRECTIONAL SQUARE IMPLEMENTATION
-
-DirSquare::DirSquare(StudentWorld* world, int startX, int startY, int dir)
- : Square(world, IID_DIR_SQUARE, startX, startY, 2, dir)
-{
-}
-
-void DirSquare::doActivity(Player* player)
-{
-    player->setWalkDir(getDirection());
-    player->setDirectedBySquare();
-}
-
-// BANK SQUARE IMPLEMENTATION
-
-BankSquare::BankSquare(StudentWorld* world, int startX, int startY)
- : Square(world, IID_BANK_SQUARE, startX, startY, 3)
-{
-}
-
-void BankSquare::doActivity(Player* player)
-{
-    cerr << "Coins: ";
-    int coinsToGive = getWorld()->getBank();
-    player->changeCoins(coinsToGive);
-    
-    cerr << "Bank coins: ";
-    getWorld()->changeBank(-coinsToGive);
-    getWorld()->playSound(SOUND_WITHDRAW_BANK);
-}
-
-void BankSquare::doActivity2(Player* player)
-{
-    cerr << "Coins: ";
-    int coinsToAdd = player->changeCoins(-5);
-    
-    cerr << "Bank coins: ";
-    getWorld()->changeBank(-coinsToAdd);
-    getWorld()->playSound(SOUND_DEPOSIT_BANK);
-}
-
-// EVENT SQUARE IMPLEMENTATION
-
-EventSquare::EventSquare(StudentWorld* world, int startX, int startY)
- : Square(world, IID_EVENT_SQUARE, startX, startY, 1)
-{
-}
-
-void EventSquare::doActivity(Player* player)
-{
-    if (player->justLanded())
-    {
-        int action = randInt(1, 3);
-        if (action == 1)
+        case coin_square:
         {
-            player->teleport();
-            getWorld()->playSound(SOUND_PLAYER_TELEPORT);
-            cerr << "Teleported\n";
+            if (walking)
+                return false;
+            worldLog("Coins: ");
+            int coins = player->changeCoins(square.coins);
+            world->logEconomy((square.coins > 0) ? econ_coins_given : econ_coins_taken, player, square.x, square.y, coins);
+            world->playSound((square.coins > 0) ? SOUND_GIVE_COIN : SOUND_TAKE_COIN);
+            world->countHeat((square.coins > 0) ? heat_coins_given : heat_coins_taken, square.x, square.y);
+            return true;
         }
-        else if (action == 2)
+        case star_square:
         {
-            player->swap(getWorld()->getOtherPlayer(player));
-            getWorld()->playSound(SOUND_PLAYER_TELEPORT);
-            cerr << "Swapped\n";
+            // Acts on players passing through as well as landing
+            if (player->getCoins() >= 20)
+            {
+                worldLog("Coins: ");
+                int coins = player->changeCoins(-20);
+                
+                worldLog("Stars: ");
+                int stars = player->changeStars(1);
+                
+                world->logEconomy(econ_star_bought, player, square.x, square.y, coins, stars);
+                world->playSound(SOUND_GIVE_STAR);
+                world->countHeat(heat_star_bought, square.x, square.y);
+            }
+            return true;
         }
-        else
+        case dir_square:
         {
-            player->changeVortex(true);
-            getWorld()->playSound(SOUND_GIVE_VORTEX);
-            cerr << "Gave a vortex\n";
+            player->setWalkDir(square.dir);
+            player->setDirectedBySquare();
+            return true;
+        }
+        case bank_square:
+        {
+            if (walking)
+            {
+                // Passing players deposit
+                worldLog("Coins: ");
+                int coinsToAdd = player->changeCoins(-5);
+                
+                worldLog("Bank coins: ");
+                world->changeBank(-coinsToAdd);
+                world->logEconomy(econ_bank_deposit, player, square.x, square.y, coinsToAdd, 0, -coinsToAdd);
+                world->playSound(SOUND_DEPOSIT_BANK);
+                world->countHeat(heat_bank_deposit, square.x, square.y);
+            }
+            else
+            {
+                // Landing players withdraw everything
+                worldLog("Coins: ");
+                int coinsToGive = world->getBank();
+                int coins = player->changeCoins(coinsToGive);
+                
+                worldLog("Bank coins: ");
+                world->changeBank(-coinsToGive);
+                world->logEconomy(econ_bank_withdrawal, player, square.x, square.y, coins, 0, -coinsToGive);
+                world->playSound(SOUND_WITHDRAW_BANK);
+                world->countHeat(heat_bank_withdrawal, square.x, square.y);
+            }
+            return true;
+        }
+        case event_square:
+        {
+            if (walking)
+                return false;
+            if (player->justLanded())
+            {
+                world->countHeat(heat_event_square, square.x, square.y);
+                int action = randInt(1, 3);
+                if (action == 1)
+                {
+                    player->teleport();
+                    world->playSound(SOUND_PLAYER_TELEPORT);
+                    worldLog("Teleported\n");
+                }
+                else if (action == 2)
+                {
+                    Player* otherPlayer = world->getOtherPlayer(player);
+                    player->swap(otherPlayer);
+                    world->logEconomy(econ_event_swap, player, square.x, square.y, 0, 0, 0, otherPlayer);
+                    world->playSound(SOUND_PLAYER_TELEPORT);
+                    worldLog("Swapped\n");
+                }
+                else
+                {
+                    player->changeVortex(true);
+                    world->playSound(SOUND_GIVE_VORTEX);
+                    worldLog("Gave a vortex\n");
+                }
+            }
+            return true;
+        }
+        case dropping_square:
+        {
+            if (walking)
+                return false;
+            int action = randInt(1, 2);
+            if (action == 1)
+            {
+                worldLog("Coins: ");
+                int coins = player->changeCoins(-10);
+                world->logEconomy(econ_dropping_coins, player, square.x, square.y, coins);
+            }
+            else
+            {
+                worldLog("Stars: ");
+                int stars = player->changeStars(-1);
+                world->logEconomy(econ_dropping_star, player, square.x, square.y, 0, stars);
+            }
+            world->playSound(SOUND_DROPPING_SQUARE_ACTIVATE);
+            world->countHeat(heat_dropping, square.x, square.y);
+            return true;
         }
     }
-}
-
-// DROPPING SQUARE IMPLEMENTATION
-
-DroppingSquare::DroppingSquare(StudentWorld* world, int startX, int startY)
- : Square(world, IID_DROPPING_SQUARE, startX, startY, 1)
-{
-}
-
-void DroppingSquare::doActivity(Player* player)
-{
-    int action = randInt(1, 2);
-    if (action == 1)
-    {
-        cerr << "Coins: ";
-        player->changeCoins(-10);
-    }
-    else
-    {
-        cerr << "Stars: ";
-        player->changeStars(-1);
-    }
-    getWorld()->playSound(SOUND_DROPPING_SQUARE_ACTIVATE);
+    return false;
 }
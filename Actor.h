@@ -2,6 +2,8 @@
 #define ACTOR_H_
 
 #include "GraphObject.h"
+#include "MoverStore.h"
+#include <cstdint>
 
 class StudentWorld;
 class Player;
@@ -11,7 +13,6 @@ class Actor : public GraphObject
 public:
     Actor(StudentWorld* world, int imageID, int startX, int startY, int dir = right, int depth = 0);
     virtual void doSomething() = 0;
-    virtual bool isSquare() const = 0;
     virtual bool canGetHitByVortex() const = 0;
     virtual void hitByVortex();
     StudentWorld* getWorld() const;
@@ -22,15 +23,53 @@ public:
     
     bool getActivation(int playerNum);
     void changeActivation(int playerNum, bool status);
-    void activateOnPlayers(int mustLand);
+    void activateOnLandedPlayers();
+    // Whether a player on this cell hasn't been acted on yet
+    bool hasPlayersToActivate() const;
     virtual void doActivity(Player* player);
-    virtual void doActivity2(Player* player);
+    
+    // Called once a dead actor is reclaimed; true if it has been detached so
+    // the world can keep it for reuse instead of deleting it
+    virtual bool retire();
+    
+    // Asked right after doSomething(): the number of ticks the actor would do
+    // nothing, so the world can skip them; -1 if it would do nothing until
+    // something else changes it
+    virtual int idleTicks() const;
+    // Whether the actor must also wake when a player arrives or leaves its cell
+    virtual bool watchesPlayers() const;
+    
+    // Asked right after doSomething() when macro-stepping: the number of
+    // ticks after this one that the actor would spend just walking straight
+    // on toward the next square
+    virtual int coastTicks() const;
+    // Moves the actor on as if it had spent numTicks ticks walking straight
+    virtual void coast(int numTicks);
+    
+    virtual void moveTo(int x, int y);
+    // Numbered in the order the world made them, the same in every run of a game
+    int getActorID() const;
+    virtual const char* typeName() const = 0;
+    // This actor's share of the world's state hash (see StateHash.h)
+    uint64_t getStateHash() const;
+protected:
+    void revive();
+    // XORs change into the actor's hash, and the world's while it's in play
+    void rehash(uint64_t change);
 private:
+    friend class StudentWorld;
     bool m_alive;
     StudentWorld* m_world;
+    int m_actorSlot;              // index in the world's actor list
+    bool m_asleep;
+    long long m_wakeTick;         // tick its timer expires, or 0 if none
+    int m_sleepCell;              // cell it watches for players, or -1
+    long long m_coastFrom;        // last tick it walked before coasting, or -1
+    int m_aliveMetric;            // MetricId counting it while in play, or -1
+    int m_actorID;
+    uint64_t m_stateHash;
     
-    bool m_activatedOnPeach;
-    bool m_activatedOnYoshi;
+    uint64_t m_activatedPlayers;  // bit n set once player n+1 has been handled here
 };
 
 // MOVER
@@ -39,9 +78,10 @@ class Mover : public Actor
 {
 public:
     Mover(StudentWorld* world, int imageID, int startX, int startY);
+    virtual ~Mover();
     virtual void doSomething() = 0;
     virtual bool canGetHitByVortex() const = 0;
-    virtual bool isSquare() const;
+    virtual void moveTo(int x, int y);
     
     bool isWalking() const;
     void setWalking(bool walking);
@@ -58,10 +98,26 @@ public:
     
     void swap(Mover* otherMover);
     virtual void teleport();
+    
+    // Movers take their 2 pixel step together after all have decided;
+    // doSomething() asks for one and afterStep() runs once it is taken
+    void requestStep();
+    void finishStep();
+    virtual void afterStep() = 0;
+    
+    virtual void coast(int numTicks);
+protected:
+    // Steps from the current position to the next square center in the walk
+    // direction, if ticks allow getting there, otherwise 0
+    int stepsToNextSquare() const;
+    // A mover out of the store keeps no movement state and must not be used
+    void leaveStore();
+    void joinStore(int x, int y);
+    MoverStore& store() const;
+    int slot() const;
 private:
-    bool m_walking;
-    int m_walkDir;
-    int m_ticksToMove;
+    friend class MoverStore;
+    int m_slot;
 };
 
 // PLAYER
@@ -73,7 +129,13 @@ public:
     virtual void doSomething();
     virtual bool canGetHitByVortex() const;
     virtual void teleport();
+    virtual void afterStep();
+    virtual int idleTicks() const;
+    virtual int coastTicks() const;
+    
+    virtual const char* typeName() const;
     
+    int getPlayerNum() const;
     void setDirectedBySquare();
     bool justLanded() const;
     int squaresToMove() const;
@@ -96,6 +158,9 @@ private:
     bool m_transported;
     bool m_hasVortex;
     bool m_directedBySquare;
+    
+    void setCoins(int coins);
+    void setStars(int stars);
 };
 
 // VORTEX
@@ -106,6 +171,11 @@ public:
     Vortex(StudentWorld* world, int startX, int startY, int dir);
     virtual void doSomething();
     virtual bool canGetHitByVortex() const;
+    virtual void afterStep();
+    virtual bool retire();
+    virtual const char* typeName() const;
+    // Fires a retired vortex again from (startX, startY)
+    void relaunch(int startX, int startY, int dir);
 };
 
 // ENEMIES
@@ -117,20 +187,27 @@ public:
     virtual void doSomething();
     virtual bool canGetHitByVortex() const;
     virtual void hitByVortex();
+    virtual void afterStep();
+    virtual int idleTicks() const;
+    virtual bool watchesPlayers() const;
+    virtual int coastTicks() const;
     
+    // The pause counter is only brought up to date when the enemy acts, so
+    // it may be behind while the enemy sleeps
     int getPauseCounter() const;
     void changePauseCounter(int pauses);
     
     virtual void doWalkingActivity();
 private:
-    int m_pauseCounter;
     int m_maxSquaresToMove;
+    long long m_pausedThrough;    // last tick counted off the pause counter
 };
 
 class Bowser : public Enemy
 {
 public:
     Bowser(StudentWorld* world, int startX, int startY);
+    virtual const char* typeName() const;
     virtual void doActivity(Player* player);
     virtual void doWalkingActivity();
 };
@@ -139,65 +216,33 @@ class Boo : public Enemy
 {
 public:
     Boo(StudentWorld* world, int startX, int startY);
+    virtual const char* typeName() const;
     virtual void doActivity(Player* player);
 };
 
 // SQUARES
 
-class Square : public Actor
-{
-public:
-    Square(StudentWorld* world, int imageID, int startX, int startY, int mustLand, int dir = right);
-    virtual void doSomething();
-    virtual bool isSquare() const;
-    virtual bool canGetHitByVortex() const;
-private:
-    int m_mustLand;
-};
-
-class CoinSquare : public Square
-{
-public:
-    CoinSquare(StudentWorld* world, int startX, int startY, bool grant);
-    virtual void doActivity(Player* player);
-private:
-    bool m_grant;
-};
-
-class StarSquare : public Square
+// Squares never move, so rather than being actors they are plain records that
+// StudentWorld keeps in an array; their behavior is selected by kind.
+enum SquareKind
 {
-public:
-    StarSquare(StudentWorld* world, int startX, int startY);
-    virtual void doActivity(Player* player);
+    coin_square, star_square, dir_square, bank_square, event_square, dropping_square
 };
 
-class DirSquare : public Square
+struct Square
 {
-public:
-    DirSquare(StudentWorld* world, int startX, int startY, int dir);
-    virtual void doActivity(Player* player);
+    uint64_t activated;       // bit n set once player n+1 has been handled here
+    unsigned char kind;
+    signed char coins;        // coin squares: coins given, negative if taken
+    short dir;                // directional squares: where players are sent
+    short x;
+    short y;
 };
 
-class BankSquare : public Square
-{
-public:
-    BankSquare(StudentWorld* world, int startX, int startY);
-    virtual void doActivity(Player* player);
-    virtual void doActivity2(Player* player);
-};
+int squareImageID(const Square& square);
 
-class EventSquare : public Square
-{
-public:
-    EventSquare(StudentWorld* world, int startX, int startY);
-    virtual void doActivity(Player* player);
-};
-
-class DroppingSquare : public Square
-{
-public:
-    DroppingSquare(StudentWorld* world, int startX, int startY);
-    virtual void doActivity(Player* player);
-};
+// Applies the square's effect to a player who has just arrived on it and
+// returns false if the square ignores players in that state
+bool activateSquare(StudentWorld* world, const Square& square, Player* player);
 
 #endif // ACTOR_H_
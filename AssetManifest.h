@@ -0,0 +1,61 @@
+#ifndef ASSETMANIFEST_H_
+#define ASSETMANIFEST_H_
+
+#include "GameConstants.h"
+
+  // Every sprite frame and sound clip the game knows about.  Both the GL
+  // front end and the headless tools load their assets from these tables.
+
+struct SpriteAsset
+{
+	int imageID;
+	int frameNum;
+	const char* tgaFileName;
+	const char* imageName;
+};
+
+struct SoundAsset
+{
+	int soundID;
+	const char* wavFileName;
+};
+
+const SpriteAsset SPRITE_ASSETS[] = {
+	{ IID_PEACH, 0, "peach1.tga", "PEACH" },
+	{ IID_PEACH, 1, "peach2.tga", "PEACH" },
+	{ IID_YOSHI, 0, "yoshi1.tga", "YOSHI" },
+	{ IID_YOSHI, 1, "yoshi2.tga", "YOSHI" },
+	{ IID_BLUE_COIN_SQUARE, 0, "blue_coin_square.tga", "BLUE COIN" },
+	{ IID_RED_COIN_SQUARE, 0, "red_coin_square.tga", "RED COIN" },
+	{ IID_DIR_SQUARE, 0, "dir_square.tga", "DIRECTION SQUARE" },
+	{ IID_EVENT_SQUARE, 0, "event_square.tga", "EVENT SQUARE" },
+	{ IID_BANK_SQUARE, 0, "bank_square.tga", "BANK SQUARE" },
+	{ IID_STAR_SQUARE, 0, "star_square.tga", "STAR SQUARE" },
+	{ IID_DROPPING_SQUARE, 0, "dropping_square.tga", "DROPPING SQUARE" },
+	{ IID_BOWSER, 0, "bowser1.tga", "BOWSER" },
+	{ IID_BOWSER, 1, "bowser2.tga", "BOWSER" },
+	{ IID_BOO, 0, "boo1.tga", "BOO" },
+	{ IID_BOO, 1, "boo2.tga", "BOO" },
+	{ IID_VORTEX, 0, "vortex1.tga", "VORTEX" },
+	{ IID_VORTEX, 1, "vortex2.tga", "VORTEX" },
+};
+
+const SoundAsset SOUND_ASSETS[] = {
+	{ SOUND_PLAYER_FIRE               , "fire.wav" },
+	{ SOUND_GIVE_COIN                 , "give_coins.wav" },
+	{ SOUND_TAKE_COIN                 , "take_coins.wav" },
+	{ SOUND_GIVE_STAR                 , "give_star.wav" },
+	{ SOUND_WITHDRAW_BANK             , "withdraw_bank.wav" },
+	{ SOUND_DEPOSIT_BANK              , "deposit_bank.wav" },
+	{ SOUND_PLAYER_TELEPORT           , "player_teleport.wav" },
+	{ SOUND_GIVE_VORTEX               , "give_vortex.wav" },
+	{ SOUND_DROPPING_SQUARE_CREATED   , "dropping_sq_created.wav" },
+	{ SOUND_DROPPING_SQUARE_ACTIVATE  , "dropping_sq_activate.wav" },
+	{ SOUND_BOWSER_ACTIVATE           , "bowser_activate.wav" },
+	{ SOUND_BOO_ACTIVATE              , "boo_activate.wav" },
+	{ SOUND_HIT_BY_VORTEX             , "hit_by_vortex.wav" },
+	{ SOUND_THEME                     , "mario_party_theme.wav" },
+	{ SOUND_GAME_FINISHED             , "game_over.wav" },
+};
+
+#endif // ASSETMANIFEST_H_
@@ -0,0 +1,318 @@
+#include "AssetPack.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+using namespace std;
+
+namespace
+{
+    const char MAGIC[8] = { 'P', 'E', 'A', 'C', 'H', 'P', 'A', 'K' };
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = 16;
+
+    static_assert(sizeof(PackEntry) == 88, "PackEntry is written to disk as is");
+
+    size_t alignUp(size_t n)
+    {
+        return (n + 15) & ~static_cast<size_t>(15);
+    }
+
+    size_t imageBytes(int width, int height)
+    {
+        return static_cast<size_t>(width) * height * 4;
+    }
+
+    int levelSide(int base, int level)
+    {
+        return max(1, base >> level);
+    }
+
+    // Resizes along one axis by averaging each destination pixel's footprint
+    // in the source, weighting the pixels it only partly covers.  Pixels
+    // along the axis are step floats apart; count lines of them, stride
+    // apart, are resized at once.
+    void resizeAxis(const float* src, float* dst, int srcSize, int dstSize, size_t step, size_t stride, int count)
+    {
+        double scale = static_cast<double>(srcSize) / dstSize;
+        for (int i = 0; i < dstSize; i++)
+        {
+            double start = i * scale;
+            double end = start + scale;
+            for (int c = 0; c < count; c++)
+            {
+                float sum[4] = { 0, 0, 0, 0 };
+                for (int j = static_cast<int>(start); j < srcSize && j < end; j++)
+                {
+                    float weight = static_cast<float>(min<double>(end, j + 1) - max<double>(start, j));
+                    const float* p = src + j * step + c * stride;
+                    for (int k = 0; k < 4; k++)
+                        sum[k] += p[k] * weight;
+                }
+                float* q = dst + i * step + c * stride;
+                for (int k = 0; k < 4; k++)
+                    q[k] = sum[k] / static_cast<float>(scale);
+            }
+        }
+    }
+
+    void resize(const vector<float>& src, int srcWidth, int srcHeight, vector<float>& dst, int dstWidth, int dstHeight)
+    {
+        // Rows first, then columns
+        vector<float> rows(static_cast<size_t>(dstWidth) * srcHeight * 4);
+        for (int y = 0; y < srcHeight; y++)
+            resizeAxis(src.data() + static_cast<size_t>(y) * srcWidth * 4, rows.data() + static_cast<size_t>(y) * dstWidth * 4,
+                       srcWidth, dstWidth, 4, 0, 1);
+        dst.assign(static_cast<size_t>(dstWidth) * dstHeight * 4, 0);
+        resizeAxis(rows.data(), dst.data(), srcHeight, dstHeight, static_cast<size_t>(dstWidth) * 4, 4, dstWidth);
+    }
+
+    void appendPixels(const vector<float>& pixels, vector<unsigned char>& out)
+    {
+        for (float v : pixels)
+            out.push_back(static_cast<unsigned char>(min(255.0f, max(0.0f, v + 0.5f))));
+    }
+}
+
+// READING
+
+bool AssetPack::open(const string& path)
+{
+    m_entries = nullptr;
+    m_numEntries = 0;
+    if (!m_file.open(path))
+        return false;
+    const unsigned char* data = m_file.data();
+    size_t size = m_file.size();
+    uint32_t version = 0;
+    uint32_t count = 0;
+    if (size >= HEADER_SIZE && memcmp(data, MAGIC, sizeof(MAGIC)) == 0)
+    {
+        memcpy(&version, data + 8, 4);
+        memcpy(&count, data + 12, 4);
+    }
+    if (version != VERSION)
+    {
+        cerr << "***** " << path << " is not an asset pack this build can read; rebuild it with packassets" << endl;
+        m_file.close();
+        return false;
+    }
+    if ((size - HEADER_SIZE) / sizeof(PackEntry) < count)
+    {
+        cerr << "***** Truncated asset pack index in " << path << endl;
+        m_file.close();
+        return false;
+    }
+    const PackEntry* entries = reinterpret_cast<const PackEntry*>(data + HEADER_SIZE);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const PackEntry& e = entries[i];
+        bool fits = e.offset <= size && e.size <= size - e.offset && e.offset % 16 == 0 &&
+                    e.name[sizeof(e.name) - 1] == '\0';
+        if (fits && e.kind == kind_sprite)
+        {
+            int mipWidth = mipBaseSize(e.width);
+            int mipHeight = mipBaseSize(e.height);
+            size_t expected = alignUp(imageBytes(e.width, e.height));
+            bool firstLevelIsImage = (mipWidth == static_cast<int>(e.width) && mipHeight == static_cast<int>(e.height));
+            for (uint32_t level = firstLevelIsImage ? 1 : 0; level < e.mipLevels; level++)
+                expected += imageBytes(levelSide(mipWidth, level), levelSide(mipHeight, level));
+            fits = e.width > 0 && e.width <= 32768 && e.height > 0 && e.height <= 32768 &&
+                   e.mipLevels >= 1 && e.mipLevels <= MAX_MIP_LEVELS && e.size == expected;
+        }
+        if (!fits)
+        {
+            cerr << "***** Corrupt entry " << i << " in asset pack " << path << endl;
+            m_file.close();
+            return false;
+        }
+    }
+    m_entries = entries;
+    m_numEntries = count;
+    return true;
+}
+
+bool AssetPack::isOpen() const
+{
+    return m_entries != nullptr;
+}
+
+const PackEntry* AssetPack::find(const string& name, uint32_t kind) const
+{
+    const PackEntry* end = m_entries + m_numEntries;
+    const PackEntry* e = lower_bound(m_entries, end, name,
+                                     [](const PackEntry& entry, const string& key) { return key.compare(entry.name) > 0; });
+    if (e == end || name != e->name || e->kind != kind)
+        return nullptr;
+    return e;
+}
+
+bool AssetPack::findSprite(const string& name, Sprite& sprite) const
+{
+    const PackEntry* e = find(name, kind_sprite);
+    if (e == nullptr)
+        return false;
+    sprite.width = e->width;
+    sprite.height = e->height;
+    sprite.rgba = m_file.data() + e->offset;
+    sprite.mipWidth = mipBaseSize(e->width);
+    sprite.mipHeight = mipBaseSize(e->height);
+    sprite.mipLevels = e->mipLevels;
+    const unsigned char* level = sprite.rgba + alignUp(imageBytes(sprite.width, sprite.height));
+    for (int n = 0; n < sprite.mipLevels; n++)
+    {
+        if (n == 0 && sprite.mipWidth == sprite.width && sprite.mipHeight == sprite.height)
+        {
+            sprite.mips[0] = sprite.rgba;
+            continue;
+        }
+        sprite.mips[n] = level;
+        level += imageBytes(levelSide(sprite.mipWidth, n), levelSide(sprite.mipHeight, n));
+    }
+    return true;
+}
+
+bool AssetPack::findSound(const string& name, Sound& sound) const
+{
+    const PackEntry* e = find(name, kind_sound);
+    if (e == nullptr)
+        return false;
+    sound.stereoFrames = reinterpret_cast<const short*>(m_file.data() + e->offset);
+    sound.numFrames = e->size / (2 * sizeof(short));
+    sound.sampleRate = e->sampleRate;
+    return true;
+}
+
+bool AssetPack::findFile(const string& name, const unsigned char*& data, size_t& size) const
+{
+    const PackEntry* e = find(name, kind_file);
+    if (e == nullptr)
+        return false;
+    data = m_file.data() + e->offset;
+    size = e->size;
+    return true;
+}
+
+int AssetPack::mipBaseSize(int size)
+{
+    // The power of two nearest size, rounding 3 * 2^n up
+    int power = 1;
+    while (size > 1)
+    {
+        if (size == 3)
+            return power * 4;
+        size >>= 1;
+        power *= 2;
+    }
+    return power;
+}
+
+// WRITING
+
+AssetPackWriter::Item& AssetPackWriter::addItem(const string& name, uint32_t kind)
+{
+    m_items.emplace_back();
+    Item& item = m_items.back();
+    memset(&item.entry, 0, sizeof(item.entry));
+    name.copy(item.entry.name, sizeof(item.entry.name) - 1);
+    item.entry.kind = kind;
+    return item;
+}
+
+void AssetPackWriter::addSprite(const string& name, const TgaImage& image)
+{
+    Item& item = addItem(name, AssetPack::kind_sprite);
+    item.entry.width = image.width;
+    item.entry.height = image.height;
+    item.bytes = image.rgba;
+    item.bytes.resize(alignUp(item.bytes.size()));
+
+    // Resize to powers of two, then halve down to 1x1
+    int width = AssetPack::mipBaseSize(image.width);
+    int height = AssetPack::mipBaseSize(image.height);
+    vector<float> level(image.rgba.begin(), image.rgba.end());
+    vector<float> next;
+    bool firstLevelIsImage = (width == image.width && height == image.height);
+    if (!firstLevelIsImage)
+    {
+        resize(level, image.width, image.height, next, width, height);
+        level.swap(next);
+    }
+    int levels = 1;
+    if (!firstLevelIsImage)
+        appendPixels(level, item.bytes);
+    while (width > 1 || height > 1)
+    {
+        int nextWidth = max(1, width / 2);
+        int nextHeight = max(1, height / 2);
+        resize(level, width, height, next, nextWidth, nextHeight);
+        level.swap(next);
+        width = nextWidth;
+        height = nextHeight;
+        appendPixels(level, item.bytes);
+        levels++;
+    }
+    item.entry.mipLevels = levels;
+}
+
+void AssetPackWriter::addSound(const string& name, const vector<short>& stereoFrames, int sampleRate)
+{
+    Item& item = addItem(name, AssetPack::kind_sound);
+    item.entry.sampleRate = sampleRate;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(stereoFrames.data());
+    item.bytes.assign(bytes, bytes + stereoFrames.size() * sizeof(short));
+}
+
+void AssetPackWriter::addFile(const string& name, const unsigned char* data, size_t size)
+{
+    Item& item = addItem(name, AssetPack::kind_file);
+    item.bytes.assign(data, data + size);
+}
+
+bool AssetPackWriter::write(const string& path, string& error) const
+{
+    vector<const Item*> items;
+    for (const Item& item : m_items)
+        items.push_back(&item);
+    sort(items.begin(), items.end(), [](const Item* a, const Item* b) { return strcmp(a->entry.name, b->entry.name) < 0; });
+    for (size_t i = 1; i < items.size(); i++)
+    {
+        if (strcmp(items[i-1]->entry.name, items[i]->entry.name) == 0)
+        {
+            error = string("Two assets are named ") + items[i]->entry.name;
+            return false;
+        }
+    }
+
+    // The index goes first, so every entry's offset is known before writing
+    vector<PackEntry> index;
+    size_t offset = alignUp(HEADER_SIZE + items.size() * sizeof(PackEntry));
+    for (const Item* item : items)
+    {
+        index.push_back(item->entry);
+        index.back().offset = offset;
+        index.back().size = item->bytes.size();
+        offset = alignUp(offset + item->bytes.size());
+    }
+
+    ofstream out(path, ios::out|ios::binary|ios::trunc);
+    uint32_t count = static_cast<uint32_t>(items.size());
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write(reinterpret_cast<const char*>(&VERSION), 4);
+    out.write(reinterpret_cast<const char*>(&count), 4);
+    out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(PackEntry));
+    const char padding[16] = {};
+    size_t written = HEADER_SIZE + index.size() * sizeof(PackEntry);
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        out.write(padding, index[i].offset - written);
+        out.write(reinterpret_cast<const char*>(items[i]->bytes.data()), items[i]->bytes.size());
+        written = index[i].offset + items[i]->bytes.size();
+    }
+    if (!out)
+    {
+        error = "Cannot write " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef ASSETPACK_H_
+#define ASSETPACK_H_
+
+#include "MappedFile.h"
+#include "TgaDecoder.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Everything in Assets/ in one file, made by packassets, with sprites and
+// sounds stored already decoded.  Opening a pack maps it once; lookups hand
+// out pointers into the mapping, so nothing is read or decoded until it's
+// used.
+//
+// Layout (little-endian):
+//   header   "PEACHPAK", version, number of entries
+//   index    one PackEntry per asset, sorted by name
+//   data     each entry's bytes, 16-byte aligned
+// Sprites are the RGBA image, bottom row first, followed by a mipmap chain
+// whose first level is the image resized to the nearest powers of two (as
+// gluBuild2DMipmaps would); when the image's sides are already powers of
+// two the chain starts at its second level.  Sounds are interleaved 16-bit
+// stereo at the rate they were packed for.  Anything else (the boards) is
+// stored as is.
+
+struct PackEntry
+{
+    char name[48];        // NUL-padded file name within Assets/
+    uint32_t kind;
+    uint32_t width;       // sprites
+    uint32_t height;
+    uint32_t mipLevels;   // levels in the chain, counting the first
+    uint32_t sampleRate;  // sounds
+    uint32_t reserved;
+    uint64_t offset;      // from the start of the file
+    uint64_t size;
+};
+
+class AssetPack
+{
+public:
+    enum Kind { kind_file = 1, kind_sprite, kind_sound };
+
+    static const int MAX_MIP_LEVELS = 16;
+
+    struct Sprite
+    {
+        int width;
+        int height;
+        const unsigned char* rgba;
+        // Level n is max(1, mipWidth >> n) by max(1, mipHeight >> n)
+        int mipWidth;
+        int mipHeight;
+        int mipLevels;
+        const unsigned char* mips[MAX_MIP_LEVELS];
+    };
+
+    struct Sound
+    {
+        const short* stereoFrames;
+        size_t numFrames;
+        int sampleRate;
+    };
+
+    // False if path can't be opened, or (with a message on cerr) isn't a
+    // pack this build reads
+    bool open(const std::string& path);
+    bool isOpen() const;
+
+    bool findSprite(const std::string& name, Sprite& sprite) const;
+    bool findSound(const std::string& name, Sound& sound) const;
+    bool findFile(const std::string& name, const unsigned char*& data, size_t& size) const;
+
+    // The side gluBuild2DMipmaps would resize an image's side to
+    static int mipBaseSize(int size);
+private:
+    MappedFile m_file;
+    const PackEntry* m_entries = nullptr;
+    size_t m_numEntries = 0;
+
+    const PackEntry* find(const std::string& name, uint32_t kind) const;
+};
+
+// Builds a pack in memory and writes it out
+class AssetPackWriter
+{
+public:
+    void addSprite(const std::string& name, const TgaImage& image);
+    void addSound(const std::string& name, const std::vector<short>& stereoFrames, int sampleRate);
+    void addFile(const std::string& name, const unsigned char* data, size_t size);
+
+    bool write(const std::string& path, std::string& error) const;
+private:
+    struct Item
+    {
+        PackEntry entry;
+        std::vector<unsigned char> bytes;
+    };
+    std::vector<Item> m_items;
+
+    Item& addItem(const std::string& name, uint32_t kind);
+};
+
+#endif // ASSETPACK_H_
@@ -0,0 +1,436 @@
+#include "AudioMixer.h"
+#include <iostream>
+#include <cstring>
+using namespace std;
+
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+static const char* const PIPE_MODE = "wb";
+#else
+static const char* const PIPE_MODE = "w";
+#endif
+
+// WAV DECODING
+
+static unsigned int readLE(const unsigned char* p, int bytes)
+{
+    unsigned int value = 0;
+    for (int i = bytes - 1; i >= 0; i--)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+// One channel of one sample as a float in [-1, 1]
+static float sampleAt(const unsigned char* p, int formatTag, int bitsPerSample)
+{
+    switch (bitsPerSample)
+    {
+        case 8:
+            return (p[0] - 128) / 128.0f;
+        case 16:
+            return static_cast<short>(readLE(p, 2)) / 32768.0f;
+        case 24:
+            return (static_cast<int>(readLE(p, 3) << 8) >> 8) / 8388608.0f;
+        case 32:
+            if (formatTag == 3)
+            {
+                float f;
+                memcpy(&f, p, 4);
+                return f;
+            }
+            return static_cast<int>(readLE(p, 4)) / 2147483648.0f;
+    }
+    return 0;
+}
+
+static short toSample(float f)
+{
+    if (f > 1)
+        f = 1;
+    else if (f < -1)
+        f = -1;
+    return static_cast<short>(f * 32767);
+}
+
+bool decodeWav(const unsigned char* data, size_t size, int sampleRate, vector<short>& stereoFrames)
+{
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0)
+        return false;
+
+    int formatTag = 0;
+    int channels = 0;
+    int rate = 0;
+    int bitsPerSample = 0;
+    const unsigned char* samples = nullptr;
+    size_t sampleBytes = 0;
+
+    // Walk the chunks; fmt and data may come in either order among others
+    size_t pos = 12;
+    while (pos + 8 <= size)
+    {
+        size_t chunkSize = readLE(data + pos + 4, 4);
+        const unsigned char* chunk = data + pos + 8;
+        if (chunkSize > size - pos - 8)
+            chunkSize = size - pos - 8;  // tolerate a truncated final chunk
+        if (memcmp(data + pos, "fmt ", 4) == 0 && chunkSize >= 16)
+        {
+            formatTag = readLE(chunk, 2);
+            channels = readLE(chunk + 2, 2);
+            rate = readLE(chunk + 4, 4);
+            bitsPerSample = readLE(chunk + 14, 2);
+            if (formatTag == 0xFFFE && chunkSize >= 26)  // WAVE_FORMAT_EXTENSIBLE
+                formatTag = readLE(chunk + 24, 2);
+        }
+        else if (memcmp(data + pos, "data", 4) == 0)
+        {
+            samples = chunk;
+            sampleBytes = chunkSize;
+        }
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (samples == nullptr || (formatTag != 1 && formatTag != 3) || channels < 1 || rate <= 0 ||
+        (bitsPerSample != 8 && bitsPerSample != 16 && bitsPerSample != 24 && bitsPerSample != 32))
+        return false;
+
+    int bytesPerFrame = channels * bitsPerSample / 8;
+    size_t inFrames = sampleBytes / bytesPerFrame;
+    if (inFrames == 0)
+    {
+        stereoFrames.clear();
+        return true;
+    }
+
+    // Linear resampling to the mixer's rate
+    size_t outFrames = static_cast<size_t>(static_cast<double>(inFrames) * sampleRate / rate);
+    stereoFrames.resize(outFrames * 2);
+    double step = static_cast<double>(rate) / sampleRate;
+    int bytesPerSample = bitsPerSample / 8;
+    for (size_t i = 0; i < outFrames; i++)
+    {
+        double srcPos = i * step;
+        size_t i0 = static_cast<size_t>(srcPos);
+        size_t i1 = (i0 + 1 < inFrames) ? i0 + 1 : i0;
+        float t = static_cast<float>(srcPos - i0);
+        for (int c = 0; c < 2; c++)
+        {
+            int srcChannel = (c < channels) ? c : 0;  // mono feeds both sides
+            float a = sampleAt(samples + i0 * bytesPerFrame + srcChannel * bytesPerSample, formatTag, bitsPerSample);
+            float b = sampleAt(samples + i1 * bytesPerFrame + srcChannel * bytesPerSample, formatTag, bitsPerSample);
+            stereoFrames[i*2 + c] = toSample(a + (b - a) * t);
+        }
+    }
+    return true;
+}
+
+bool decodeWavFile(const string& filename, int sampleRate, vector<short>& stereoFrames)
+{
+    ifstream wavFile(filename, ios::in|ios::binary);
+    if (!wavFile)
+        return false;
+    vector<unsigned char> contents((istreambuf_iterator<char>(wavFile)), istreambuf_iterator<char>());
+    return decodeWav(contents.data(), contents.size(), sampleRate, stereoFrames);
+}
+
+// NULL DEVICE IMPLEMENTATION
+
+NullAudioDevice::NullAudioDevice(int sampleRate, bool paced)
+{
+    m_sampleRate = sampleRate;
+    m_paced = paced;
+    m_started = false;
+}
+
+bool NullAudioDevice::write(const short* frames, int numFrames)
+{
+    if (!m_paced)
+        return true;
+    auto now = chrono::steady_clock::now();
+    if (!m_started || m_nextWrite < now - chrono::milliseconds(100))
+    {
+        // First block, or we fell far behind: restart the clock
+        m_nextWrite = now;
+        m_started = true;
+    }
+    m_nextWrite += chrono::microseconds(1000000LL * numFrames / m_sampleRate);
+    this_thread::sleep_until(m_nextWrite);
+    return true;
+}
+
+// WAV FILE DEVICE IMPLEMENTATION
+
+WavFileAudioDevice::WavFileAudioDevice(int sampleRate, bool paced)
+ : m_pacer(sampleRate, paced)
+{
+    m_sampleRate = sampleRate;
+    m_framesWritten = 0;
+}
+
+WavFileAudioDevice::~WavFileAudioDevice()
+{
+    close();
+}
+
+static void putLE(ostream& out, unsigned int value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+static void writeWavHeader(ostream& out, int sampleRate, long long frames)
+{
+    unsigned int dataBytes = static_cast<unsigned int>(frames * 4);
+    out.write("RIFF", 4);
+    putLE(out, 36 + dataBytes, 4);
+    out.write("WAVEfmt ", 8);
+    putLE(out, 16, 4);
+    putLE(out, 1, 2);                // PCM
+    putLE(out, 2, 2);                // stereo
+    putLE(out, sampleRate, 4);
+    putLE(out, sampleRate * 4, 4);   // bytes per second
+    putLE(out, 4, 2);                // bytes per frame
+    putLE(out, 16, 2);               // bits per sample
+    out.write("data", 4);
+    putLE(out, dataBytes, 4);
+}
+
+bool WavFileAudioDevice::open(const string& filename)
+{
+    close();
+    m_file.open(filename, ios::out|ios::binary|ios::trunc);
+    if (!m_file)
+        return false;
+    m_framesWritten = 0;
+    writeWavHeader(m_file, m_sampleRate, 0);  // sizes are patched in close()
+    return static_cast<bool>(m_file);
+}
+
+bool WavFileAudioDevice::write(const short* frames, int numFrames)
+{
+    if (!m_file.is_open())
+        return false;
+    // WAV data is little-endian, like every platform we build on
+    m_file.write(reinterpret_cast<const char*>(frames), numFrames * 4);
+    m_framesWritten += numFrames;
+    m_pacer.write(frames, numFrames);
+    return static_cast<bool>(m_file);
+}
+
+void WavFileAudioDevice::close()
+{
+    if (!m_file.is_open())
+        return;
+    m_file.seekp(0);
+    writeWavHeader(m_file, m_sampleRate, m_framesWritten);
+    m_file.close();
+}
+
+// PIPE DEVICE IMPLEMENTATION
+
+PipeAudioDevice::PipeAudioDevice()
+{
+    m_pipe = nullptr;
+}
+
+PipeAudioDevice::~PipeAudioDevice()
+{
+    if (m_pipe != nullptr)
+        pclose(m_pipe);
+}
+
+bool PipeAudioDevice::open(const string& command)
+{
+    m_pipe = popen(command.c_str(), PIPE_MODE);
+    return m_pipe != nullptr;
+}
+
+bool PipeAudioDevice::write(const short* frames, int numFrames)
+{
+    if (m_pipe == nullptr)
+        return false;
+    return fwrite(frames, 4, numFrames, m_pipe) == static_cast<size_t>(numFrames);
+}
+
+// MIXER IMPLEMENTATION
+
+AudioMixer::AudioMixer()
+ : m_commandsDropped(0), m_numVoices(0), m_running(false)
+{
+    m_accum.resize(BLOCK_FRAMES * 2);
+    m_out.resize(BLOCK_FRAMES * 2);
+}
+
+AudioMixer::~AudioMixer()
+{
+    stop();
+}
+
+bool AudioMixer::loadClip(int soundID, const string& filename)
+{
+    vector<short> frames;
+    if (!decodeWavFile(filename, SAMPLE_RATE, frames))
+        return false;
+    return storeClip(soundID, frames);
+}
+
+bool AudioMixer::loadClipFromMemory(int soundID, const unsigned char* data, size_t size)
+{
+    vector<short> frames;
+    if (!decodeWav(data, size, SAMPLE_RATE, frames))
+        return false;
+    return storeClip(soundID, frames);
+}
+
+bool AudioMixer::useClip(int soundID, const short* stereoFrames, size_t numFrames)
+{
+    Clip* clip = clipSlot(soundID);
+    if (clip == nullptr)
+        return false;
+    clip->decoded.clear();
+    clip->frames = stereoFrames;
+    clip->numFrames = numFrames;
+    return true;
+}
+
+bool AudioMixer::storeClip(int soundID, vector<short>& frames)
+{
+    Clip* clip = clipSlot(soundID);
+    if (clip == nullptr)
+        return false;
+    clip->decoded.swap(frames);
+    clip->frames = clip->decoded.data();
+    clip->numFrames = clip->decoded.size() / 2;
+    return true;
+}
+
+AudioMixer::Clip* AudioMixer::clipSlot(int soundID)
+{
+    // Clips can only change while the audio thread is stopped
+    if (soundID < 0 || m_running)
+        return nullptr;
+    if (soundID >= static_cast<int>(m_clips.size()))
+        m_clips.resize(soundID + 1);
+    return &m_clips[soundID];
+}
+
+void AudioMixer::setDevice(AudioDevice* device)
+{
+    stop();
+    m_device.reset(device);
+}
+
+bool AudioMixer::start()
+{
+    if (m_running || m_device == nullptr)
+        return false;
+    m_running = true;
+    m_thread = thread(&AudioMixer::audioLoop, this);
+    return true;
+}
+
+void AudioMixer::stop()
+{
+    if (!m_running)
+        return;
+    m_running = false;
+    m_thread.join();
+}
+
+void AudioMixer::render(int numFrames)
+{
+    if (m_running || m_device == nullptr)
+        return;
+    while (numFrames > 0)
+    {
+        int frames = (numFrames < BLOCK_FRAMES) ? numFrames : BLOCK_FRAMES;
+        drainCommands();
+        mixBlock(frames);
+        m_device->write(m_out.data(), frames);
+        numFrames -= frames;
+    }
+}
+
+void AudioMixer::play(int soundID)
+{
+    if (soundID < 0 || soundID >= static_cast<int>(m_clips.size()) || m_clips[soundID].numFrames == 0)
+        return;
+    if (!m_commands.push(Command{ Command::play_clip, soundID }))
+        m_commandsDropped++;
+}
+
+void AudioMixer::stopAll()
+{
+    if (!m_commands.push(Command{ Command::stop_all, 0 }))
+        m_commandsDropped++;
+}
+
+long long AudioMixer::commandsDropped() const
+{
+    return m_commandsDropped;
+}
+
+void AudioMixer::audioLoop()
+{
+    while (m_running)
+    {
+        drainCommands();
+        mixBlock(BLOCK_FRAMES);
+        // The device paces us; a real device blocks until it wants more
+        if (!m_device->write(m_out.data(), BLOCK_FRAMES))
+            this_thread::sleep_for(chrono::microseconds(1000000LL * BLOCK_FRAMES / SAMPLE_RATE));
+    }
+}
+
+void AudioMixer::drainCommands()
+{
+    Command cmd;
+    while (m_commands.pop(cmd))
+    {
+        if (cmd.type == Command::stop_all)
+        {
+            m_numVoices = 0;
+            continue;
+        }
+        Voice voice = { &m_clips[cmd.soundID], 0 };
+        if (m_numVoices < MAX_VOICES)
+            m_voices[m_numVoices++] = voice;
+        else
+        {
+            // Steal the voice that has been playing longest
+            int oldest = 0;
+            for (int i = 1; i < m_numVoices; i++)
+                if (m_voices[i].frame > m_voices[oldest].frame)
+                    oldest = i;
+            m_voices[oldest] = voice;
+        }
+    }
+}
+
+void AudioMixer::mixBlock(int numFrames)
+{
+    int numSamples = numFrames * 2;
+    fill(m_accum.begin(), m_accum.begin() + numSamples, 0);
+
+    for (int v = 0; v < m_numVoices; )
+    {
+        Voice& voice = m_voices[v];
+        const short* src = voice.clip->frames + voice.frame * 2;
+        size_t remaining = voice.clip->numFrames - voice.frame;
+        int frames = (remaining < static_cast<size_t>(numFrames)) ? static_cast<int>(remaining) : numFrames;
+        for (int i = 0; i < frames * 2; i++)
+            m_accum[i] += src[i];
+        voice.frame += frames;
+
+        if (voice.frame >= voice.clip->numFrames)
+            m_voices[v] = m_voices[--m_numVoices];  // finished
+        else
+            v++;
+    }
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        int s = m_accum[i];
+        m_out[i] = static_cast<short>((s > 32767) ? 32767 : (s < -32768) ? -32768 : s);
+    }
+}
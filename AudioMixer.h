@@ -0,0 +1,141 @@
+#ifndef AUDIOMIXER_H_
+#define AUDIOMIXER_H_
+
+#include "SpscQueue.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <cstdio>
+
+// Decode a RIFF WAVE file (8/16/24/32-bit PCM or 32-bit float, mono or
+// stereo) into interleaved 16-bit stereo at sampleRate.
+bool decodeWav(const unsigned char* data, size_t size, int sampleRate, std::vector<short>& stereoFrames);
+bool decodeWavFile(const std::string& filename, int sampleRate, std::vector<short>& stereoFrames);
+
+// Where mixed audio goes.  Frames are interleaved 16-bit stereo.
+
+class AudioDevice
+{
+public:
+    virtual ~AudioDevice() {}
+    virtual bool write(const short* frames, int numFrames) = 0;
+};
+
+// Discards audio.  If paced, write() sleeps so the mixer runs in real time.
+class NullAudioDevice : public AudioDevice
+{
+public:
+    NullAudioDevice(int sampleRate, bool paced);
+    virtual bool write(const short* frames, int numFrames);
+private:
+    int m_sampleRate;
+    bool m_paced;
+    std::chrono::steady_clock::time_point m_nextWrite;
+    bool m_started;
+};
+
+// Records the mix to a .wav file
+class WavFileAudioDevice : public AudioDevice
+{
+public:
+    WavFileAudioDevice(int sampleRate, bool paced);
+    virtual ~WavFileAudioDevice();
+    bool open(const std::string& filename);
+    virtual bool write(const short* frames, int numFrames);
+    void close();
+private:
+    NullAudioDevice m_pacer;
+    int m_sampleRate;
+    std::ofstream m_file;
+    long long m_framesWritten;
+};
+
+// Streams raw PCM into a long-lived player process (e.g. aplay reading
+// stdin), so the process is started once rather than per clip
+class PipeAudioDevice : public AudioDevice
+{
+public:
+    PipeAudioDevice();
+    virtual ~PipeAudioDevice();
+    bool open(const std::string& command);
+    virtual bool write(const short* frames, int numFrames);
+private:
+    FILE* m_pipe;
+};
+
+// Mixes any number of overlapping clips.  Every clip is decoded into
+// memory up front (or, from an asset pack, was decoded when it was packed); play() only pushes a command onto a lock-free queue
+// that the audio thread drains between blocks.
+
+class AudioMixer
+{
+public:
+    static const int SAMPLE_RATE = 48000;
+    static const int BLOCK_FRAMES = 512;
+    static const int MAX_VOICES = 32;
+
+    AudioMixer();
+    ~AudioMixer();
+
+    bool loadClip(int soundID, const std::string& filename);
+    bool loadClipFromMemory(int soundID, const unsigned char* data, size_t size);
+    // Plays already-decoded frames in place; they must outlive the mixer
+    bool useClip(int soundID, const short* stereoFrames, size_t numFrames);
+    void setDevice(AudioDevice* device);  // takes ownership
+
+    // Mix on a dedicated thread until stop()
+    bool start();
+    void stop();
+
+    // Mix numFrames on the caller's thread (offline rendering, no start())
+    void render(int numFrames);
+
+    // Call from a single producer thread
+    void play(int soundID);
+    void stopAll();
+
+    long long commandsDropped() const;
+private:
+    struct Command
+    {
+        enum Type { play_clip, stop_all } type;
+        int soundID;
+    };
+
+    struct Clip
+    {
+        std::vector<short> decoded;   // empty if the frames are borrowed
+        const short* frames = nullptr;
+        size_t numFrames = 0;
+    };
+
+    struct Voice
+    {
+        const Clip* clip;
+        size_t frame;
+    };
+
+    std::vector<Clip> m_clips;  // indexed by sound ID
+    std::unique_ptr<AudioDevice> m_device;
+    SpscQueue<Command, 256> m_commands;
+    std::atomic<long long> m_commandsDropped;
+    Voice m_voices[MAX_VOICES];
+    int m_numVoices;
+    std::vector<int> m_accum;
+    std::vector<short> m_out;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    bool storeClip(int soundID, std::vector<short>& frames);
+    Clip* clipSlot(int soundID);
+    void audioLoop();
+    void drainCommands();
+    void mixBlock(int numFrames);
+};
+
+#endif // AUDIOMIXER_H_
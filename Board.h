@@ -5,6 +5,9 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <iterator>
+#include <cctype>
+#include <cstdio>
 
 class Board
 {
@@ -29,36 +32,82 @@ public:
 	{
 		std::ifstream boardFile(filename);
 		if (!boardFile)
+		{
+			setError(0, 0, "cannot open file");
 			return load_fail_file_not_found;
+		}
+		std::string text((std::istreambuf_iterator<char>(boardFile)),
+		                 std::istreambuf_iterator<char>());
+		return parseBoard(text.data(), text.size());
+	}
+
+	  // Same as loadBoard, for a board already in memory (e.g. a mapped file)
+	LoadResult parseBoard(const char* text, size_t length)
+	{
+		m_errorLine = 0;
+		m_errorColumn = 0;
+		m_errorMessage.clear();
 
 		  // get the grid
 
-		std::string line;
 		int numPlayerLocations = 0;
+		int extraPlayerLine = 0;
+		int extraPlayerColumn = 0;
+		size_t pos = 0;
+		int lineNum = 0;
 
-		for (int gy = BOARD_HEIGHT-1; std::getline(boardFile, line); gy--)
+		for (int gy = BOARD_HEIGHT-1; pos < length; gy--)
 		{
+			const char* line = text + pos;
+			size_t lineLength = 0;
+			while (pos + lineLength < length  &&  line[lineLength] != '\n')
+				lineLength++;
+			pos += lineLength + 1;
+			lineNum++;
+
 			if (gy < 0)  // too many grid lines?
 			{
-				if (line.find_first_not_of(" \t\r") != std::string::npos)
-					return load_fail_bad_format;  // non-blank line
-				char dummy;
-				if (boardFile >> dummy)  // non-blank rest of file
-					return load_fail_bad_format;
+				for (size_t i = 0; i < lineLength; i++)
+					if (!isBlank(line[i]))
+						return setError(lineNum, i+1, "text after the last board row");
+				  // the rest of the file must be white space too
+				int col = 0;
+				for ( ; pos < length; pos++)
+				{
+					col++;
+					if (text[pos] == '\n')
+					{
+						lineNum++;
+						col = 0;
+					}
+					else if (!std::isspace(static_cast<unsigned char>(text[pos])))
+						return setError(lineNum+1, col, "text after the last board row");
+				}
 				break;
 			}
-			if (line.size() < BOARD_WIDTH  ||
-					line.find_first_not_of(" \t\r", BOARD_WIDTH) != std::string::npos)
-				return load_fail_bad_format;
+			if (lineLength < BOARD_WIDTH)
+				return setError(lineNum, lineLength+1, "row is shorter than " +
+				                std::to_string(BOARD_WIDTH) + " columns");
+			for (size_t i = BOARD_WIDTH; i < lineLength; i++)
+				if (!isBlank(line[i]))
+					return setError(lineNum, i+1, "text after the last board column");
 
 			for (int gx = 0; gx < BOARD_WIDTH; gx++)
 			{
 				GridEntry ge;
 				switch (line[gx])
 				{
-					default:  return load_fail_bad_format;
+					default:
+						return setError(lineNum, gx+1, describeBadChar(line[gx]));
 					case ' ': ge = empty; break;
-					case '@': ge = player; numPlayerLocations++; break;
+					case '@':
+						ge = player;
+						if (++numPlayerLocations == 2)
+						{
+							extraPlayerLine = lineNum;
+							extraPlayerColumn = gx+1;
+						}
+						break;
 					case '+': ge = blue_coin_square; break;
 					case '-': ge = red_coin_square; break;
 					case '<': ge = left_dir_square; break;
@@ -74,13 +123,32 @@ public:
 				m_grid[gy][gx] = ge;
 			}
 		}
-		if (numPlayerLocations != 1)
-			return load_fail_bad_format;
+		if (numPlayerLocations == 0)
+			return setError(0, 0, "no player start ('@')");
+		if (numPlayerLocations > 1)
+			return setError(extraPlayerLine, extraPlayerColumn, "more than one player start ('@')");
 
 		return load_success;
 	}
 
-	GridEntry getContentsOf(int gx, int gy)
+	  // Where and why the last load failed; line and column count from 1 and
+	  // are 0 for problems with the file as a whole
+	int getErrorLine() const
+	{
+		return m_errorLine;
+	}
+
+	int getErrorColumn() const
+	{
+		return m_errorColumn;
+	}
+
+	std::string getErrorMessage() const
+	{
+		return m_errorMessage;
+	}
+
+	GridEntry getContentsOf(int gx, int gy) const
 	{
 		if (gx < 0  ||  gx >= BOARD_WIDTH  ||  gy < 0  ||  gy >= BOARD_HEIGHT)
 			return empty;
@@ -88,8 +156,74 @@ public:
 		return m_grid[gy][gx];
 	}
 
+	  // For boards built in code rather than loaded (see BoardGenerator)
+	void setContentsOf(int gx, int gy, GridEntry ge)
+	{
+		if (gx >= 0  &&  gx < BOARD_WIDTH  &&  gy >= 0  &&  gy < BOARD_HEIGHT)
+			m_grid[gy][gx] = ge;
+	}
+
+	  // The board in the format loadBoard reads
+	std::string toText() const
+	{
+		std::string text;
+		text.reserve(BOARD_HEIGHT * (BOARD_WIDTH+1));
+		for (int gy = BOARD_HEIGHT-1; gy >= 0; gy--)
+		{
+			for (int gx = 0; gx < BOARD_WIDTH; gx++)
+				text.push_back(symbolFor(m_grid[gy][gx]));
+			text.push_back('\n');
+		}
+		return text;
+	}
+
+	static char symbolFor(GridEntry ge)
+	{
+		switch (ge)
+		{
+			default:                return ' ';
+			case player:            return '@';
+			case blue_coin_square:  return '+';
+			case red_coin_square:   return '-';
+			case left_dir_square:   return '<';
+			case right_dir_square:  return '>';
+			case up_dir_square:     return '^';
+			case down_dir_square:   return 'v';
+			case event_square:      return '!';
+			case bank_square:       return '$';
+			case star_square:       return '*';
+			case bowser:            return 'B';
+			case boo:               return 'b';
+		}
+	}
+
 private:
 	GridEntry m_grid[BOARD_HEIGHT][BOARD_WIDTH];  // indexed by [gy][gx]
+	int m_errorLine = 0;
+	int m_errorColumn = 0;
+	std::string m_errorMessage;
+
+	static bool isBlank(char c)
+	{
+		return c == ' '  ||  c == '\t'  ||  c == '\r';
+	}
+
+	static std::string describeBadChar(char c)
+	{
+		if (std::isprint(static_cast<unsigned char>(c)))
+			return std::string("unknown board character '") + c + "'";
+		char code[8];
+		std::snprintf(code, sizeof(code), "0x%02x", static_cast<unsigned char>(c));
+		return std::string("unknown board character ") + code;
+	}
+
+	LoadResult setError(int line, size_t column, const std::string& message)
+	{
+		m_errorLine = line;
+		m_errorColumn = static_cast<int>(column);
+		m_errorMessage = message;
+		return load_fail_bad_format;
+	}
 };
 
 #endif // #ifndef BOARD_H_
@@ -0,0 +1,313 @@
+#include "BoardCheck.h"
+#include "Board.h"
+#include "GameConstants.h"
+#include <algorithm>
+using namespace std;
+
+namespace
+{
+    const int NUM_CELLS = BOARD_WIDTH * BOARD_HEIGHT;
+
+    // Directions are indexed like the GraphObject angles divided by 90
+    enum { RIGHT, UP, LEFT, DOWN };
+    const int DX[4] = { 1, 0, -1, 0 };
+    const int DY[4] = { 0, 1, 0, -1 };
+
+    int reverseOf(int d)
+    {
+        return (d + 2) & 3;
+    }
+
+    // Cell d of each cell, or -1 off the board
+    struct NeighborTable
+    {
+        int of[NUM_CELLS][4];
+
+        NeighborTable()
+        {
+            for (int cell = 0; cell < NUM_CELLS; cell++)
+            {
+                for (int d = 0; d < 4; d++)
+                {
+                    int x = cell % BOARD_WIDTH + DX[d];
+                    int y = cell / BOARD_WIDTH + DY[d];
+                    bool onBoard = (x >= 0 && x < BOARD_WIDTH && y >= 0 && y < BOARD_HEIGHT);
+                    of[cell][d] = onBoard ? y * BOARD_WIDTH + x : -1;
+                }
+            }
+        }
+    };
+    const NeighborTable NEIGHBORS;
+
+    struct Layout
+    {
+        bool isSquare[NUM_CELLS];
+        int forcedDir[NUM_CELLS];   // direction squares: the direction they set, else -1
+        int start;
+
+        int neighbor(int cell, int d) const
+        {
+            return NEIGHBORS.of[cell][d];
+        }
+
+        unsigned char exitMask[NUM_CELLS];   // bit d set if cell d of a square is a square too
+        unsigned char numExits[NUM_CELLS];
+
+        void findExits()
+        {
+            for (int cell = 0; cell < NUM_CELLS; cell++)
+            {
+                exitMask[cell] = 0;
+                numExits[cell] = 0;
+                if (!isSquare[cell])
+                    continue;
+                for (int d = 0; d < 4; d++)
+                {
+                    int next = neighbor(cell, d);
+                    if (next >= 0 && isSquare[next])
+                    {
+                        exitMask[cell] |= 1 << d;
+                        numExits[cell]++;
+                    }
+                }
+            }
+        }
+
+        bool canGo(int cell, int d) const
+        {
+            return (exitMask[cell] >> d) & 1;
+        }
+
+        int countExits(int cell) const
+        {
+            return numExits[cell];
+        }
+    };
+
+    void addIssue(vector<BoardIssue>& issues, BoardIssue::Kind kind, bool error, int cell,
+                  const string& message)
+    {
+        int x = cell % BOARD_WIDTH;
+        int y = cell / BOARD_WIDTH;
+        issues.push_back(BoardIssue{ kind, error, BOARD_HEIGHT - y, x + 1, message });
+    }
+
+    // A player's state between squares: the cell arrived at and the
+    // direction walked in to get there, as cell * 4 + direction
+    int stateOf(int cell, int d)
+    {
+        return cell * 4 + d;
+    }
+
+    // Where a player can go next from state; returns how many states were
+    // put in next
+    int successors(const Layout& layout, int state, int next[4])
+    {
+        int cell = state / 4;
+        int d = state % 4;
+        int count = 0;
+        auto leave = [&](int e)
+        {
+            next[count++] = stateOf(layout.neighbor(cell, e), e);
+        };
+
+        if (layout.forcedDir[cell] >= 0)
+        {
+            if (layout.canGo(cell, layout.forcedDir[cell]))
+                leave(layout.forcedDir[cell]);
+        }
+        else if (layout.countExits(cell) > 2)
+        {
+            for (int e = 0; e < 4; e++)
+                if (e != reverseOf(d) && layout.canGo(cell, e))
+                    leave(e);
+        }
+        else if (layout.canGo(cell, d))
+            leave(d);
+        else
+        {
+            // Turning a corner: either perpendicular way that's open
+            for (int e = 0; e < 4; e++)
+                if (e != d && e != reverseOf(d) && layout.canGo(cell, e))
+                    leave(e);
+        }
+        return count;
+    }
+
+    const int NUM_STATES = NUM_CELLS * 4;
+
+    // Marks every state a player can walk into, leaving the start in any
+    // direction, and of those, the ones from which the start can be walked
+    // back to
+    void markReachable(const Layout& layout, bool reached[NUM_STATES], bool returns[NUM_STATES])
+    {
+        // A state is entered from one neighboring cell, arriving there any of 4 ways
+        int predecessors[NUM_STATES][4];
+        int numPredecessors[NUM_STATES] = {};
+        int frontier[NUM_STATES];    // each state is pushed at most once
+        int top = 0;
+        fill(reached, reached + NUM_STATES, false);
+        fill(returns, returns + NUM_STATES, false);
+
+        for (int d = 0; d < 4; d++)
+        {
+            if (layout.canGo(layout.start, d))
+            {
+                int state = stateOf(layout.neighbor(layout.start, d), d);
+                if (!reached[state])
+                {
+                    reached[state] = true;
+                    frontier[top++] = state;
+                }
+            }
+        }
+        while (top > 0)
+        {
+            int state = frontier[--top];
+            int next[4];
+            int numNext = successors(layout, state, next);
+            for (int i = 0; i < numNext; i++)
+            {
+                predecessors[next[i]][numPredecessors[next[i]]++] = state;
+                if (!reached[next[i]])
+                {
+                    reached[next[i]] = true;
+                    frontier[top++] = next[i];
+                }
+            }
+        }
+
+        // Walk backwards from arriving at the start
+        for (int d = 0; d < 4; d++)
+        {
+            int state = stateOf(layout.start, d);
+            if (reached[state])
+            {
+                returns[state] = true;
+                frontier[top++] = state;
+            }
+        }
+        while (top > 0)
+        {
+            int state = frontier[--top];
+            for (int i = 0; i < numPredecessors[state]; i++)
+            {
+                int prev = predecessors[state][i];
+                if (!returns[prev])
+                {
+                    returns[prev] = true;
+                    frontier[top++] = prev;
+                }
+            }
+        }
+    }
+}
+
+int checkBoardLayout(const Board& board, vector<BoardIssue>& issues)
+{
+    static const char* const ARROW_NAMES[4] = { "right", "up", "left", "down" };
+
+    Layout layout;
+    layout.start = -1;
+    for (int cell = 0; cell < NUM_CELLS; cell++)
+    {
+        Board::GridEntry ge = board.getContentsOf(cell % BOARD_WIDTH, cell / BOARD_WIDTH);
+        layout.isSquare[cell] = (ge != Board::empty);
+        switch (ge)
+        {
+            case Board::right_dir_square: layout.forcedDir[cell] = RIGHT; break;
+            case Board::up_dir_square:    layout.forcedDir[cell] = UP; break;
+            case Board::left_dir_square:  layout.forcedDir[cell] = LEFT; break;
+            case Board::down_dir_square:  layout.forcedDir[cell] = DOWN; break;
+            default:                      layout.forcedDir[cell] = -1; break;
+        }
+        if (ge == Board::player)
+            layout.start = cell;
+    }
+    layout.findExits();
+
+    size_t firstIssue = issues.size();
+    vector<int> trapCells;
+    bool reachedState[NUM_STATES];
+    bool returnsState[NUM_STATES];
+    if (layout.start >= 0)
+        markReachable(layout, reachedState, returnsState);
+
+    for (int cell = 0; cell < NUM_CELLS; cell++)
+    {
+        if (!layout.isSquare[cell])
+            continue;
+        int exits = layout.countExits(cell);
+        int forced = layout.forcedDir[cell];
+        bool arrowLeadsOn = (forced >= 0 && layout.canGo(cell, forced));
+
+        if (exits == 0)
+            addIssue(issues, BoardIssue::isolated_square, true, cell,
+                     "square has no neighboring squares");
+        else if (forced >= 0 && !arrowLeadsOn)
+            addIssue(issues, BoardIssue::off_path_arrow, true, cell,
+                     string("direction square points ") + ARROW_NAMES[forced] + " off the path");
+        else if (exits == 1 && !arrowLeadsOn)
+            addIssue(issues, BoardIssue::dead_end, true, cell,
+                     "dead end: movers arriving here walk off the board");
+
+        if (layout.start >= 0 && cell != layout.start)
+        {
+            bool reached = false, trapped = false;
+            for (int d = 0; d < 4; d++)
+            {
+                int state = stateOf(cell, d);
+                reached = reached || reachedState[state];
+                trapped = trapped || (reachedState[state] && !returnsState[state]);
+            }
+            if (!reached)
+                addIssue(issues, BoardIssue::unreachable_square, false, cell,
+                         "square can't be reached by walking from the start");
+            else if (trapped)
+                trapCells.push_back(cell);
+        }
+
+        // Arrows on forks are how one-way merges are drawn; only forks that
+        // players actually choose at are checked
+        if (exits > 2 && forced < 0)
+        {
+            for (int d = 0; d < 4; d++)
+            {
+                int next = layout.neighbor(cell, d);
+                if (next < 0 || !layout.isSquare[next])
+                    continue;
+                if (layout.forcedDir[next] == reverseOf(d))
+                {
+                    addIssue(issues, BoardIssue::degenerate_fork, false, cell,
+                             string("fork's ") + ARROW_NAMES[d] + " exit is an arrow straight back");
+                    break;
+                }
+                if (layout.forcedDir[next] < 0 && layout.countExits(next) > 2)
+                {
+                    addIssue(issues, BoardIssue::degenerate_fork, false, cell,
+                             "fork is next to another fork");
+                    break;
+                }
+            }
+        }
+    }
+
+    // Movers walking off the board or stuck in a dead end strand players
+    // too; traps are only worth reporting once those are fixed
+    bool hasErrors = any_of(issues.begin() + firstIssue, issues.end(),
+                            [](const BoardIssue& issue) { return issue.error; });
+    if (!hasErrors)
+    {
+        for (int cell : trapCells)
+            addIssue(issues, BoardIssue::one_way_trap, false, cell,
+                     "players walking through here can never get back to the start");
+    }
+
+    stable_sort(issues.begin() + firstIssue, issues.end(),
+                [](const BoardIssue& a, const BoardIssue& b)
+                {
+                    return a.line != b.line ? a.line < b.line : a.column < b.column;
+                });
+    return static_cast<int>(count_if(issues.begin() + firstIssue, issues.end(),
+                                     [](const BoardIssue& issue) { return issue.error; }));
+}
@@ -0,0 +1,34 @@
+#ifndef BOARDCHECK_H_
+#define BOARDCHECK_H_
+
+#include <string>
+#include <vector>
+
+class Board;
+
+// A problem with a board's layout, at a place in its file
+struct BoardIssue
+{
+    enum Kind {
+        isolated_square,     // no neighboring squares: choosing a random direction there fails
+        dead_end,            // one neighboring square: movers arriving there walk off the board
+        off_path_arrow,      // a direction square pointing away from every square
+        unreachable_square,  // players can't walk there from the start
+        one_way_trap,        // players can walk there but, by some way, never back to the start
+        degenerate_fork      // a fork with an exit straight back to it, or right next to another
+    };
+    Kind kind;
+    bool error;       // the game misbehaves on this board, rather than just playing oddly
+    int line;         // 1-based; line 1 is the top row of the board
+    int column;       // 1-based
+    std::string message;
+};
+
+// Checks what Board::loadBoard can't: that movers can always go somewhere
+// and that players can walk to every square from the start and back.  Walking
+// follows the game's rules (direction squares, turning at corners, no
+// turning back at forks); teleports are not taken into account.  Appends
+// the problems found, in file order, and returns how many were errors.
+int checkBoardLayout(const Board& board, std::vector<BoardIssue>& issues);
+
+#endif // BOARDCHECK_H_
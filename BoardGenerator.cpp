@@ -0,0 +1,276 @@
+#include "BoardGenerator.h"
+#include "Board.h"
+#include "BoardCheck.h"
+#include "GameConstants.h"
+#include <cmath>
+#include <vector>
+using namespace std;
+
+namespace
+{
+    const int MAX_LINES = 8;    // lines at least 2 cells apart on a 16-cell side
+    const int NUM_CELLS = BOARD_WIDTH * BOARD_HEIGHT;
+    const int MIN_SQUARES = 16;
+    const int MAX_ATTEMPTS = 10000;   // layouts to try before deciding a recipe can't be met
+
+    // A rasterized stretch of path between two grid vertices, for placing
+    // direction squares on
+    struct Stretch
+    {
+        int fromX, fromY;     // the lower or left end
+        int toX, toY;
+        bool vertical;
+        bool fromFork, toFork;
+    };
+
+    // Squares of a kind for a density; nonzero densities place at least one
+    int countFor(double density, int numSquares)
+    {
+        if (density <= 0)
+            return 0;
+        return max(1, static_cast<int>(lround(density * numSquares)));
+    }
+}
+
+BoardGenerator::BoardGenerator(unsigned int seed)
+ : m_rng(seed), m_rejected(0)
+{
+}
+
+bool BoardGenerator::generate(const BoardRecipe& recipe, Board& board)
+{
+    vector<BoardIssue> issues;
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
+    {
+        board = Board();
+        if (layOut(recipe, board))
+        {
+            issues.clear();
+            if (checkBoardLayout(board, issues) == 0 && issues.empty())
+                return true;
+        }
+        m_rejected++;
+    }
+    return false;
+}
+
+long long BoardGenerator::rejected() const
+{
+    return m_rejected;
+}
+
+int BoardGenerator::pick(int n)
+{
+    // Scaling rather than a distribution object: fast, and the same on every
+    // standard library
+    unsigned long long range = m_rng.max() - m_rng.min() + 1ULL;
+    return static_cast<int>((m_rng() - m_rng.min()) * static_cast<unsigned long long>(n) / range);
+}
+
+bool BoardGenerator::chance(double p)
+{
+    return m_rng() - m_rng.min() < p * (m_rng.max() - m_rng.min() + 1.0);
+}
+
+bool BoardGenerator::layOut(const BoardRecipe& recipe, Board& board)
+{
+    // Grid lines 2 to 5 cells apart
+    int cols[MAX_LINES], rows[MAX_LINES];
+    int numCols = 0, numRows = 0;
+    for (int x = pick(3); x < BOARD_WIDTH && numCols < MAX_LINES; x += 2 + pick(4))
+        cols[numCols++] = x;
+    for (int y = pick(3); y < BOARD_HEIGHT && numRows < MAX_LINES; y += 2 + pick(4))
+        rows[numRows++] = y;
+
+    // right[r][c] joins vertex (c, r) to (c+1, r); up[r][c] joins it to (c, r+1)
+    bool right[MAX_LINES][MAX_LINES] = {};
+    bool up[MAX_LINES][MAX_LINES] = {};
+    for (int r = 0; r < numRows; r++)
+    {
+        for (int c = 0; c < numCols; c++)
+        {
+            right[r][c] = (c + 1 < numCols) && chance(recipe.paths);
+            up[r][c] = (r + 1 < numRows) && chance(recipe.paths);
+        }
+    }
+    auto degree = [&](int r, int c)
+    {
+        return right[r][c] + up[r][c] + (c > 0 && right[r][c-1]) + (r > 0 && up[r-1][c]);
+    };
+
+    // Prune dead ends until none are left
+    for (bool pruned = true; pruned; )
+    {
+        pruned = false;
+        for (int r = 0; r < numRows; r++)
+        {
+            for (int c = 0; c < numCols; c++)
+            {
+                if (degree(r, c) != 1)
+                    continue;
+                right[r][c] = up[r][c] = false;
+                if (c > 0)
+                    right[r][c-1] = false;
+                if (r > 0)
+                    up[r-1][c] = false;
+                pruned = true;
+            }
+        }
+    }
+
+    // Keep the connected piece with the most stretches
+    int piece[MAX_LINES][MAX_LINES];
+    int bestPiece = -1, bestSize = 0;
+    int stack[MAX_LINES * MAX_LINES];
+    for (int r = 0; r < numRows; r++)
+        for (int c = 0; c < numCols; c++)
+            piece[r][c] = -1;
+    for (int r = 0; r < numRows; r++)
+    {
+        for (int c = 0; c < numCols; c++)
+        {
+            if (piece[r][c] >= 0 || degree(r, c) == 0)
+                continue;
+            int id = r * MAX_LINES + c;
+            int size = 0;
+            int top = 0;
+            piece[r][c] = id;
+            stack[top++] = id;
+            while (top > 0)
+            {
+                int vr = stack[--top] / MAX_LINES;
+                int vc = stack[top] % MAX_LINES;
+                size += degree(vr, vc);
+                auto visit = [&](int nr, int nc)
+                {
+                    if (piece[nr][nc] < 0)
+                    {
+                        piece[nr][nc] = id;
+                        stack[top++] = nr * MAX_LINES + nc;
+                    }
+                };
+                if (right[vr][vc])
+                    visit(vr, vc + 1);
+                if (up[vr][vc])
+                    visit(vr + 1, vc);
+                if (vc > 0 && right[vr][vc-1])
+                    visit(vr, vc - 1);
+                if (vr > 0 && up[vr-1][vc])
+                    visit(vr - 1, vc);
+            }
+            if (size > bestSize)
+            {
+                bestSize = size;
+                bestPiece = id;
+            }
+        }
+    }
+    if (bestPiece < 0)
+        return false;
+
+    // Lay the squares of the kept piece
+    bool isSquare[NUM_CELLS] = {};
+    int squares[NUM_CELLS];
+    int numSquares = 0;
+    Stretch stretches[2 * MAX_LINES * MAX_LINES];
+    int numStretches = 0;
+    auto lay = [&](int x, int y)
+    {
+        int cell = y * BOARD_WIDTH + x;
+        if (!isSquare[cell])
+        {
+            isSquare[cell] = true;
+            squares[numSquares++] = cell;
+        }
+    };
+    for (int r = 0; r < numRows; r++)
+    {
+        for (int c = 0; c < numCols; c++)
+        {
+            if (piece[r][c] != bestPiece)
+                continue;
+            if (right[r][c])
+            {
+                for (int x = cols[c]; x <= cols[c+1]; x++)
+                    lay(x, rows[r]);
+                stretches[numStretches++] = Stretch{ cols[c], rows[r], cols[c+1], rows[r], false,
+                                                     degree(r, c) > 2, degree(r, c + 1) > 2 };
+            }
+            if (up[r][c])
+            {
+                for (int y = rows[r]; y <= rows[r+1]; y++)
+                    lay(cols[c], y);
+                stretches[numStretches++] = Stretch{ cols[c], rows[r], cols[c], rows[r+1], true,
+                                                     degree(r, c) > 2, degree(r + 1, c) > 2 };
+            }
+        }
+    }
+    if (numSquares < MIN_SQUARES)
+        return false;
+
+    Board::GridEntry kinds[NUM_CELLS];
+    for (int i = 0; i < numSquares; i++)
+        kinds[squares[i]] = Board::blue_coin_square;
+
+    // Direction squares go inside stretches, at most one to a stretch, and
+    // never pointing straight back into a fork
+    int numArrows = min(countFor(recipe.arrows, numSquares), numStretches);
+    for (int i = 0; i < numArrows; i++)
+    {
+        int s = i + pick(numStretches - i);
+        std::swap(stretches[i], stretches[s]);
+        const Stretch& st = stretches[i];
+        int length = st.vertical ? st.toY - st.fromY : st.toX - st.fromX;
+        int step = 1 + pick(length - 1);    // inside the stretch, not on a vertex
+        int x = st.vertical ? st.fromX : st.fromX + step;
+        int y = st.vertical ? st.fromY + step : st.fromY;
+        bool forward = chance(0.5);
+        if (forward && step == length - 1 && st.toFork)
+            forward = false;
+        if (!forward && step == 1 && st.fromFork)
+            forward = true;
+        if ((forward && step == length - 1 && st.toFork) || (!forward && step == 1 && st.fromFork))
+            continue;   // a one-cell stretch between two forks
+        if (st.vertical)
+            kinds[y * BOARD_WIDTH + x] = forward ? Board::up_dir_square : Board::down_dir_square;
+        else
+            kinds[y * BOARD_WIDTH + x] = forward ? Board::right_dir_square : Board::left_dir_square;
+    }
+
+    // Everything else goes on the remaining coin squares, in random order
+    int open[NUM_CELLS];
+    int numOpen = 0;
+    for (int i = 0; i < numSquares; i++)
+        if (kinds[squares[i]] == Board::blue_coin_square)
+            open[numOpen++] = squares[i];
+    struct Placement
+    {
+        Board::GridEntry kind;
+        int count;
+    };
+    const Placement placements[] = {
+        { Board::player,          1 },
+        { Board::bowser,          recipe.bowsers },
+        { Board::boo,             recipe.boos },
+        { Board::star_square,     countFor(recipe.stars, numSquares) },
+        { Board::bank_square,     countFor(recipe.banks, numSquares) },
+        { Board::event_square,    countFor(recipe.events, numSquares) },
+        { Board::red_coin_square, countFor(recipe.redCoins, numSquares) },
+    };
+    int used = 0;
+    for (const Placement& p : placements)
+    {
+        for (int n = 0; n < p.count; n++)
+        {
+            if (used == numOpen)
+                return false;
+            int o = used + pick(numOpen - used);
+            std::swap(open[used], open[o]);
+            kinds[open[used++]] = p.kind;
+        }
+    }
+
+    for (int i = 0; i < numSquares; i++)
+        board.setContentsOf(squares[i] % BOARD_WIDTH, squares[i] / BOARD_WIDTH, kinds[squares[i]]);
+    return true;
+}
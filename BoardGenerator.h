@@ -0,0 +1,47 @@
+#ifndef BOARDGENERATOR_H_
+#define BOARDGENERATOR_H_
+
+#include <random>
+
+class Board;
+
+// What goes on a generated board.  Densities are fractions of the squares
+// on the path; a nonzero density always places at least one square.
+struct BoardRecipe
+{
+    double paths = 0.7;       // chance each stretch of the underlying grid of paths is laid
+    double redCoins = 0.06;
+    double stars = 0.03;
+    double banks = 0.02;
+    double events = 0.08;
+    double arrows = 0.03;     // direction squares, making stretches one-way
+    int bowsers = 1;
+    int boos = 2;
+};
+
+// Makes random boards for sweeps that shouldn't depend on the nine in
+// Assets/.  The path is a random subset of a grid of rows and columns, kept
+// two cells apart so forks are never adjacent, with dead ends pruned and
+// only the largest connected piece kept.  Each layout is checked with
+// checkBoardLayout and redrawn until it has no issues at all, so every board
+// loads and plays.  The same seed and recipe always give the same boards.
+class BoardGenerator
+{
+public:
+    BoardGenerator(unsigned int seed);
+
+    // False if no layout fits the recipe (e.g. too many enemies)
+    bool generate(const BoardRecipe& recipe, Board& board);
+
+    // Layouts drawn and thrown away so far
+    long long rejected() const;
+private:
+    std::minstd_rand m_rng;     // cheap to seed, as every board gets its own
+    long long m_rejected;
+
+    int pick(int n);    // 0 to n-1
+    bool chance(double p);
+    bool layOut(const BoardRecipe& recipe, Board& board);
+};
+
+#endif // BOARDGENERATOR_H_
@@ -0,0 +1,79 @@
+#include "Bot.h"
+#include "Actor.h"
+#include "GameConstants.h"
+#include "StudentWorld.h"
+using namespace std;
+
+// RANDOM BOT IMPLEMENTATION
+
+RandomBot::RandomBot(unsigned int seed)
+ : m_rng(seed)
+{
+}
+
+int RandomBot::choose(int min, int max)
+{
+    std::uniform_int_distribution<> distro(min, max);
+    return distro(m_rng);
+}
+
+const char* RandomBot::name() const
+{
+    return "random";
+}
+
+void RandomBot::act(StudentWorld* world, int playerNum)
+{
+    if (world->hasPendingAction(playerNum))
+        return;
+    Player* player = world->getPlayer(playerNum);
+    if (!player->isWalking())
+    {
+        if (player->hasVortex() && choose(0, 3) == 0)
+            world->submitAction(playerNum, ACTION_FIRE, source_bot);
+        else
+            world->submitAction(playerNum, ACTION_ROLL, source_bot);
+    }
+    else
+        // Only consumed if the player reaches a fork
+        world->submitAction(playerNum, choose(ACTION_LEFT, ACTION_DOWN), source_bot);
+}
+
+// Only acts once its last action has been consumed
+bool RandomBot::isWaiting(StudentWorld* world, int playerNum) const
+{
+    return world->hasPendingAction(playerNum);
+}
+
+// IDLE BOT IMPLEMENTATION
+
+const char* IdleBot::name() const
+{
+    return "idle";
+}
+
+void IdleBot::act(StudentWorld* world, int playerNum)
+{
+}
+
+bool IdleBot::isWaiting(StudentWorld* world, int playerNum) const
+{
+    return true;
+}
+
+Bot* createBot(string name, unsigned int seed)
+{
+    if (name == "random")
+        return new RandomBot(seed);
+    if (name == "idle")
+        return new IdleBot;
+    return nullptr;
+}
+
+int botIndex(const string& name)
+{
+    for (int i = 0; i < NUM_BOTS; i++)
+        if (name == BOT_NAMES[i])
+            return i;
+    return -1;
+}
@@ -0,0 +1,58 @@
+#ifndef BOT_H_
+#define BOT_H_
+
+#include <string>
+#include <random>
+
+class StudentWorld;
+
+// A computer player that feeds actions to one player of a headless world.
+
+class Bot
+{
+public:
+    virtual ~Bot() {}
+    virtual const char* name() const = 0;
+    
+    // Called once per tick before the world moves
+    virtual void act(StudentWorld* world, int playerNum) = 0;
+    // Whether act() would do nothing now, so quiet ticks can be skipped
+    virtual bool isWaiting(StudentWorld* world, int playerNum) const = 0;
+};
+
+// Rolls whenever idle, picks random directions at forks and fires any vortex.
+// It draws from its own generator so that a game replayed without the bot
+// sees the same random sequence as the recorded one.
+class RandomBot : public Bot
+{
+public:
+    RandomBot(unsigned int seed);
+    virtual const char* name() const;
+    virtual void act(StudentWorld* world, int playerNum);
+    virtual bool isWaiting(StudentWorld* world, int playerNum) const;
+private:
+    std::default_random_engine m_rng;
+    int choose(int min, int max);
+};
+
+// Never does anything; useful as a baseline opponent
+class IdleBot : public Bot
+{
+public:
+    virtual const char* name() const;
+    virtual void act(StudentWorld* world, int playerNum);
+    virtual bool isWaiting(StudentWorld* world, int playerNum) const;
+};
+
+// Returns nullptr if no bot has that name
+Bot* createBot(std::string name, unsigned int seed);
+
+// The names createBot knows, numbered in this order in match logs; add new
+// bots at the end so old logs keep their meaning
+const char* const BOT_NAMES[] = { "random", "idle" };
+const int NUM_BOTS = sizeof(BOT_NAMES) / sizeof(BOT_NAMES[0]);
+
+// Index into BOT_NAMES, or -1 if no bot has that name
+int botIndex(const std::string& name);
+
+#endif // BOT_H_
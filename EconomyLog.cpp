@@ -0,0 +1,116 @@
+#include "EconomyLog.h"
+#include "GameConstants.h"
+#include <cstring>
+using namespace std;
+
+namespace
+{
+    const char MAGIC[8] = { 'P', 'E', 'A', 'C', 'H', 'E', 'C', 'O' };
+    const uint32_t VERSION = 1;
+
+    static_assert(sizeof(EconomyEvent) == 32, "EconomyEvent is written to disk as is");
+
+    const char* const EVENT_NAMES[NUM_ECONOMY_EVENTS] = {
+        "coins_given", "coins_taken", "star_bought", "bank_deposit",
+        "bank_withdrawal", "dropping_coins", "dropping_star",
+        "bowser_robbery", "boo_coin_swap", "boo_star_swap",
+        "event_swap"
+    };
+}
+
+const char* economyEventName(int kind)
+{
+    return (kind >= 0 && kind < NUM_ECONOMY_EVENTS) ? EVENT_NAMES[kind] : "unknown";
+}
+
+EconomyLog::EconomyLog(size_t capacity)
+ : m_events(capacity > 0 ? capacity : 1), m_count(0), m_spilled(0), m_spillFailed(false)
+{
+}
+
+EconomyLog::~EconomyLog()
+{
+    flush();
+}
+
+bool EconomyLog::spillTo(const string& path)
+{
+    flush();
+    m_spill.close();
+    m_spillFailed = false;
+    m_spill.open(path, ios::out|ios::binary|ios::trunc);
+    if (!m_spill)
+        return false;
+    uint32_t eventSize = sizeof(EconomyEvent);
+    m_spill.write(MAGIC, sizeof(MAGIC));
+    m_spill.write(reinterpret_cast<const char*>(&VERSION), 4);
+    m_spill.write(reinterpret_cast<const char*>(&eventSize), 4);
+    return true;
+}
+
+bool EconomyLog::flush()
+{
+    if (!m_spill.is_open())
+        return true;
+    m_spill.write(reinterpret_cast<const char*>(m_events.data()), m_count * sizeof(EconomyEvent));
+    m_spilled += m_count;
+    m_count = 0;
+    if (!m_spill.flush())
+        m_spillFailed = true;
+    return !m_spillFailed;
+}
+
+void EconomyLog::makeRoom()
+{
+    if (m_spill.is_open())
+        flush();
+    else
+        m_events.resize(m_events.size() * 2);
+}
+
+const EconomyEvent* EconomyLog::events() const
+{
+    return m_events.data();
+}
+
+size_t EconomyLog::size() const
+{
+    return m_count;
+}
+
+long long EconomyLog::totalEvents() const
+{
+    return m_spilled + m_count;
+}
+
+void EconomyLog::clear()
+{
+    m_count = 0;
+}
+
+void EconomyLog::writeCsv(ostream& out) const
+{
+    out << "tick,event,player,other_player,x,y,coins,stars,bank,coins_after,stars_after,bank_after\n";
+    for (size_t i = 0; i < m_count; i++)
+    {
+        const EconomyEvent& e = m_events[i];
+        out << e.tick << "," << economyEventName(e.kind) << "," << int(e.player) << "," << int(e.otherPlayer) << ","
+            << e.cell % BOARD_WIDTH << "," << e.cell / BOARD_WIDTH << "," << e.coins << "," << e.stars << ","
+            << e.bank << "," << e.coinsAfter << "," << e.starsAfter << "," << e.bankAfter << "\n";
+    }
+}
+
+bool EconomyLog::load(const string& path, vector<EconomyEvent>& events)
+{
+    ifstream in(path, ios::in|ios::binary);
+    char magic[8];
+    uint32_t header[2];
+    if (!in.read(magic, sizeof(magic)) || !in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || header[0] != VERSION || header[1] != sizeof(EconomyEvent))
+        return false;
+    events.clear();
+    EconomyEvent event;
+    while (in.read(reinterpret_cast<char*>(&event), sizeof(event)))
+        events.push_back(event);
+    return in.gcount() == 0;
+}
@@ -0,0 +1,88 @@
+#ifndef ECONOMYLOG_H_
+#define ECONOMYLOG_H_
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+// Every movement of coins and stars in a game, for exact accounts of its
+// economy
+enum EconomyEventKind {
+    econ_coins_given, econ_coins_taken, econ_star_bought, econ_bank_deposit,
+    econ_bank_withdrawal, econ_dropping_coins, econ_dropping_star,
+    econ_bowser_robbery, econ_boo_coin_swap, econ_boo_star_swap,
+    econ_event_swap, NUM_ECONOMY_EVENTS
+};
+
+const char* economyEventName(int kind);
+
+// One transaction.  The changes are what was actually applied (a player
+// can't go below zero).  In a swap, otherPlayer's coins or stars change by
+// the opposite amount; an event-square swap trades places only, so records
+// no change.  Summing a player's changes, and the other sides of their
+// swaps, gives their final coins and stars.
+struct EconomyEvent
+{
+    uint32_t tick;
+    uint8_t kind;
+    uint8_t player;
+    uint8_t otherPlayer;     // swaps, else 0
+    uint8_t cell;            // board cell: y * BOARD_WIDTH + x
+    int32_t coins;           // change to player's coins
+    int32_t stars;
+    int32_t bank;            // change to the bank
+    int32_t coinsAfter;      // player's balances afterwards
+    int32_t starsAfter;
+    int32_t bankAfter;
+};
+
+// A world's ledger: events are appended to a buffer allocated up front.
+// When it fills, it is written to the spill file if there is one, and
+// otherwise grows.  A world without a ledger pays one null check per
+// transaction.
+//
+// Spill files are "PEACHECO", a version and the event size, then the raw
+// events (little-endian).
+class EconomyLog
+{
+public:
+    EconomyLog(size_t capacity = 4096);
+    ~EconomyLog();
+
+    // Buffered events go to path from now on; false if it can't be created
+    bool spillTo(const std::string& path);
+    // Writes the buffered events out; false if a write failed
+    bool flush();
+
+    void add(const EconomyEvent& event)
+    {
+        if (m_count == m_events.size())
+            makeRoom();
+        m_events[m_count++] = event;
+    }
+
+    // Events still in the buffer (all of them if there's no spill file)
+    const EconomyEvent* events() const;
+    size_t size() const;
+    long long totalEvents() const;
+    void clear();
+
+    // One CSV line per event in the buffer, after a heading line
+    void writeCsv(std::ostream& out) const;
+
+    // Reads a spill file
+    static bool load(const std::string& path, std::vector<EconomyEvent>& events);
+private:
+    std::vector<EconomyEvent> m_events;
+    size_t m_count;
+    long long m_spilled;
+    std::ofstream m_spill;
+    bool m_spillFailed;
+
+    void makeRoom();
+};
+
+#endif // ECONOMYLOG_H_
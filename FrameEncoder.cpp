@@ -0,0 +1,167 @@
+#include "FrameEncoder.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+using namespace std;
+
+FrameEncoder::FrameEncoder()
+{
+    m_format = ppm_sequence;
+    m_width = 0;
+    m_height = 0;
+    m_maxQueuedFrames = 0;
+    m_lossless = false;
+    m_open = false;
+    m_closing = false;
+    m_framesWritten = 0;
+    m_framesDropped = 0;
+}
+
+FrameEncoder::~FrameEncoder()
+{
+    close();
+}
+
+bool FrameEncoder::open(string path, Format format, int width, int height, int fps,
+                        int maxQueuedFrames, bool lossless)
+{
+    close();
+    m_format = format;
+    m_path = path;
+    m_width = width;
+    m_height = height;
+    m_maxQueuedFrames = (maxQueuedFrames < 1) ? 1 : maxQueuedFrames;
+    m_lossless = lossless;
+    m_framesWritten = 0;
+    m_framesDropped = 0;
+    m_closing = false;
+
+    if (m_format == y4m_video)
+    {
+        m_video.open(path, ios::out|ios::binary|ios::trunc);
+        if (!m_video)
+        {
+            cerr << "***** Unable to create " << path << endl;
+            return false;
+        }
+        // Full 4:4:4 chroma keeps the 16-pixel sprites legible
+        m_video << "YUV4MPEG2 W" << width << " H" << height << " F" << fps << ":1 Ip A1:1 C444\n";
+    }
+
+    m_open = true;
+    m_thread = thread(&FrameEncoder::encoderLoop, this);
+    return true;
+}
+
+bool FrameEncoder::submitFrame(const vector<unsigned char>& rgba)
+{
+    unique_lock<mutex> lock(m_mutex);
+    if (m_open && m_lossless)
+        m_spaceCv.wait(lock, [this] { return static_cast<int>(m_queue.size()) < m_maxQueuedFrames; });
+    if (!m_open || static_cast<int>(m_queue.size()) >= m_maxQueuedFrames)
+    {
+        m_framesDropped++;
+        return false;
+    }
+    vector<unsigned char> frame;
+    if (!m_freeBuffers.empty())
+    {
+        frame.swap(m_freeBuffers.back());
+        m_freeBuffers.pop_back();
+    }
+    frame.assign(rgba.begin(), rgba.end());
+    m_queue.push_back(std::move(frame));
+    m_cv.notify_one();
+    return true;
+}
+
+void FrameEncoder::close()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (!m_open)
+            return;
+        m_closing = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    if (m_video.is_open())
+        m_video.close();
+    m_open = false;
+}
+
+int FrameEncoder::framesWritten() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_framesWritten;
+}
+
+int FrameEncoder::framesDropped() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_framesDropped;
+}
+
+void FrameEncoder::encoderLoop()
+{
+    vector<unsigned char> scratch;
+    for (;;)
+    {
+        vector<unsigned char> frame;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_closing || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;  // closing and fully drained
+            frame.swap(m_queue.front());
+            m_queue.pop_front();
+        }
+        m_spaceCv.notify_one();
+
+        writeFrame(frame, scratch);
+
+        lock_guard<mutex> lock(m_mutex);
+        m_framesWritten++;
+        m_freeBuffers.push_back(std::move(frame));
+    }
+}
+
+void FrameEncoder::writeFrame(const vector<unsigned char>& rgba, vector<unsigned char>& scratch)
+{
+    size_t numPixels = static_cast<size_t>(m_width) * m_height;
+    scratch.resize(numPixels * 3);
+
+    if (m_format == ppm_sequence)
+    {
+        for (size_t i = 0; i < numPixels; i++)
+        {
+            scratch[i*3]   = rgba[i*4];
+            scratch[i*3+1] = rgba[i*4+1];
+            scratch[i*3+2] = rgba[i*4+2];
+        }
+        ostringstream name;
+        name << m_path << setw(6) << setfill('0') << m_framesWritten << ".ppm";
+        ofstream ppm(name.str(), ios::out|ios::binary|ios::trunc);
+        ppm << "P6\n" << m_width << " " << m_height << "\n255\n";
+        ppm.write(reinterpret_cast<const char*>(scratch.data()), scratch.size());
+        if (!ppm)
+            cerr << "***** Unable to write " << name.str() << endl;
+        return;
+    }
+
+    // BT.601 studio-range RGB -> Y'CbCr, written as three planes
+    unsigned char* yPlane = scratch.data();
+    unsigned char* uPlane = yPlane + numPixels;
+    unsigned char* vPlane = uPlane + numPixels;
+    for (size_t i = 0; i < numPixels; i++)
+    {
+        int r = rgba[i*4];
+        int g = rgba[i*4+1];
+        int b = rgba[i*4+2];
+        yPlane[i] = static_cast<unsigned char>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        uPlane[i] = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        vPlane[i] = static_cast<unsigned char>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+    m_video << "FRAME\n";
+    m_video.write(reinterpret_cast<const char*>(scratch.data()), scratch.size());
+}
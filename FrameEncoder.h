@@ -0,0 +1,58 @@
+#ifndef FRAMEENCODER_H_
+#define FRAMEENCODER_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+
+// Writes captured RGBA frames to disk on a background thread.  Frames
+// submitted while the queue is full are dropped rather than stalling the
+// caller, unless the encoder was opened as lossless.
+
+class FrameEncoder
+{
+public:
+    enum Format {
+        ppm_sequence, y4m_video
+    };
+
+    FrameEncoder();
+    ~FrameEncoder();
+
+    // For ppm_sequence, path is a prefix: frames go to <path>000000.ppm, ...
+    bool open(std::string path, Format format, int width, int height, int fps,
+              int maxQueuedFrames = 32, bool lossless = false);
+    bool submitFrame(const std::vector<unsigned char>& rgba);
+    void close();
+
+    int framesWritten() const;
+    int framesDropped() const;
+private:
+    Format m_format;
+    std::string m_path;
+    int m_width;
+    int m_height;
+    int m_maxQueuedFrames;
+    bool m_lossless;
+    bool m_open;
+    bool m_closing;
+    int m_framesWritten;
+    int m_framesDropped;
+    std::ofstream m_video;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_spaceCv;
+    std::deque<std::vector<unsigned char>> m_queue;
+    std::vector<std::vector<unsigned char>> m_freeBuffers;
+
+    void encoderLoop();
+    void writeFrame(const std::vector<unsigned char>& rgba, std::vector<unsigned char>& scratch);
+};
+
+#endif // FRAMEENCODER_H_
@@ -1,6 +1,7 @@
 #ifndef GAMECONSTANTS_H_
 #define GAMECONSTANTS_H_
 
+#include "WorldPolicy.h"
 #include <random>
 #include <utility>
 
@@ -80,11 +81,33 @@ const int GWSTATUS_PEACH_WON       = 1;
 const int GWSTATUS_YOSHI_WON       = 2;
 const int GWSTATUS_BOARD_ERROR     = 3;
 const int GWSTATUS_NOT_IMPLEMENTED = 4;
+const int GWSTATUS_PLAYER_WON      = 5;  // a player after the first two; see getWinner()
+
+// players on one board; the GUI always plays two, headless runs up to this many
+
+const int MAX_PLAYERS = 64;
 
 // test parameter constants
 
 const int NUM_TEST_PARAMS = 1;
 
+// The engine behind randInt; seeded from the system unless seedRandInt is
+// called.  Shared by the game, per thread in headless builds.
+
+inline
+std::default_random_engine& randIntEngine()
+{
+	return WorldPolicy::rng();
+}
+
+// Make subsequent randInt calls reproducible (used by headless runs)
+
+inline
+void seedRandInt(unsigned int seed)
+{
+	randIntEngine().seed(seed);
+}
+
 // Return a uniformly distributed random int from min to max, inclusive
 
 inline
@@ -92,10 +115,8 @@ int randInt(int min, int max)
 {
 	if (max < min)
 		std::swap(max, min);
-	static std::random_device rd;
-	static std::default_random_engine generator(rd());
 	std::uniform_int_distribution<> distro(min, max);
-	return distro(generator);
+	return distro(randIntEngine());
 }
 
 #endif // GAMECONSTANTS_H_
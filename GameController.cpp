@@ -4,11 +4,14 @@
 #endif
 #include "freeglut.h"
 #include "GameController.h"
+#include "AssetManifest.h"
+#include "AssetPack.h"
 #include "GameWorld.h"
 #include "GameConstants.h"
 #include "GraphObject.h"
 #include "SoundFX.h"
 #include "SpriteManager.h"
+#include "StrokeText.h"
 #include <iostream>
 #include <string>
 #include <map>
@@ -16,6 +19,9 @@
 #include <utility>
 #include <cstdlib>
 #include <algorithm>
+#include <fstream>
+#include <cmath>
+#include <iomanip>
 using namespace std;
 
 /*
@@ -54,13 +60,20 @@ static const double FONT_SCALEDOWN = 760.0;
 static const double SCORE_Y = 3.8;
 static const double SCORE_Z = -10;
 
+static const double PERF_OVERLAY_Y = 3.5;
+static const double PERF_TEXT_REFRESH_MS = 250;
+
 static const int MS_PER_FRAME = 5;
 
+  // Don't restart a sound that started fewer than this many ticks ago
+static const int SOUND_COALESCE_TICKS = 3;
+
 int GameController::m_ms_per_tick = kDefaultMsPerTick;
 
 static void convertToGlutCoords(double x, double y, double& gx, double& gy, double& gz);
-static void drawPrompt(string mainMessage, string secondMessage);
-static void drawScoreAndLives(string);
+static void drawPrompt(const string& mainMessage, const string& secondMessage);
+static void drawScoreAndLives(const string&);
+static void drawPerfOverlay(const string&);
 
 enum GameController::GameControllerState : int {
     welcome, init, cleanup, makemove, animate, gameover, prompt, quit, not_applicable
@@ -68,77 +81,113 @@ enum GameController::GameControllerState : int {
 
 void GameController::initDrawersAndSounds()
 {
-
-	struct SpriteInfo
-	{
-		int imageID;
-		int frameNum;
-		string tgaFileName;
-		string imageName;
-	};
-
-	const SpriteInfo drawers[] = {
-		{ IID_PEACH, 0, "peach1.tga", "PEACH" },
-		{ IID_PEACH, 1, "peach2.tga", "PEACH" },
-		{ IID_YOSHI, 0, "yoshi1.tga", "YOSHI" },
-		{ IID_YOSHI, 1, "yoshi2.tga", "YOSHI" },
-		{ IID_BLUE_COIN_SQUARE, 0, "blue_coin_square.tga", "BLUE COIN" },
-		{ IID_RED_COIN_SQUARE, 0, "red_coin_square.tga", "RED COIN" },
-		{ IID_DIR_SQUARE, 0, "dir_square.tga", "DIRECTION SQUARE" },
-		{ IID_EVENT_SQUARE, 0, "event_square.tga", "EVENT SQUARE" },
-		{ IID_BANK_SQUARE, 0, "bank_square.tga", "BANK SQUARE" },
-		{ IID_STAR_SQUARE, 0, "star_square.tga", "STAR SQUARE" },
-		{ IID_DROPPING_SQUARE, 0, "dropping_square.tga", "DROPPING SQUARE" },
-		{ IID_BOWSER, 0, "bowser1.tga", "BOWSER" },
-		{ IID_BOWSER, 1, "bowser2.tga", "BOWSER" },
-		{ IID_BOO, 0, "boo1.tga", "BOO" },
-		{ IID_BOO, 1, "boo2.tga", "BOO" },
-		{ IID_VORTEX, 0, "vortex1.tga", "VORTEX" },
-		{ IID_VORTEX, 1, "vortex2.tga", "VORTEX" },
-	};
-
-	m_soundMap = {
-		{ SOUND_PLAYER_FIRE               , "fire.wav" },
-		{ SOUND_GIVE_COIN                 , "give_coins.wav" },
-		{ SOUND_TAKE_COIN                 , "take_coins.wav" },
-		{ SOUND_GIVE_STAR                 , "give_star.wav" },
-		{ SOUND_WITHDRAW_BANK             , "withdraw_bank.wav" },
-		{ SOUND_DEPOSIT_BANK              , "deposit_bank.wav" },
-		{ SOUND_PLAYER_TELEPORT           , "player_teleport.wav" },
-		{ SOUND_GIVE_VORTEX               , "give_vortex.wav" },
-		{ SOUND_DROPPING_SQUARE_CREATED   , "dropping_sq_created.wav" },
-		{ SOUND_DROPPING_SQUARE_ACTIVATE  , "dropping_sq_activate.wav" },
-		{ SOUND_BOWSER_ACTIVATE           , "bowser_activate.wav" },
-		{ SOUND_BOO_ACTIVATE              , "boo_activate.wav" },
-		{ SOUND_HIT_BY_VORTEX             , "hit_by_vortex.wav" },
-		{ SOUND_THEME                     , "mario_party_theme.wav" },
-		{ SOUND_GAME_FINISHED             , "game_over.wav" },
-	};
+	for (const auto& s : SOUND_ASSETS)
+		m_soundMap[s.soundID] = s.wavFileName;
 
 	string path = m_gw->assetPath();
+	const AssetPack* pack = m_gw->assetPack();
 
-	for (const auto& d : drawers)
+	for (const auto& d : SPRITE_ASSETS)
 	{
-		if (!m_spriteManager.loadSprite(path + d.tgaFileName, d.imageID, d.frameNum))
+		AssetPack::Sprite sprite;
+		bool loaded;
+		if (pack != nullptr)
+			loaded = pack->findSprite(d.tgaFileName, sprite)  &&  m_spriteManager.loadSprite(sprite, d.imageID, d.frameNum);
+		else
+			loaded = m_spriteManager.loadSprite(path + d.tgaFileName, d.imageID, d.frameNum);
+		if (!loaded)
 		{
 			cerr << "***** Error loading sprite: " << (path + d.tgaFileName) << endl;
 			setGameState(quit);
 		}
 		m_imageNameMap[d.imageID] = d.imageName;
 	}
+
+	initAudioMixer();
+}
+
+  // PEACH_AUDIO selects the in-process mixer instead of the platform's
+  // one-clip-at-a-time player:
+  //   null         mix in real time but discard the output
+  //   wav:FILE     record the mix to FILE
+  //   pipe:COMMAND stream 48kHz 16-bit stereo PCM into COMMAND's stdin,
+  //                e.g. pipe:aplay -q -f S16_LE -c 2 -r 48000
+void GameController::initAudioMixer()
+{
+	const char* spec = getenv("PEACH_AUDIO");
+	if (spec == nullptr  ||  *spec == '\0')
+		return;
+
+	string device = spec;
+	AudioDevice* audioDevice = nullptr;
+	if (device == "null")
+		audioDevice = new NullAudioDevice(AudioMixer::SAMPLE_RATE, true);
+	else if (device.compare(0, 4, "wav:") == 0)
+	{
+		WavFileAudioDevice* wav = new WavFileAudioDevice(AudioMixer::SAMPLE_RATE, true);
+		if (wav->open(device.substr(4)))
+			audioDevice = wav;
+		else
+			delete wav;
+	}
+	else if (device.compare(0, 5, "pipe:") == 0)
+	{
+		PipeAudioDevice* pipe = new PipeAudioDevice;
+		if (pipe->open(device.substr(5)))
+			audioDevice = pipe;
+		else
+			delete pipe;
+	}
+	if (audioDevice == nullptr)
+	{
+		cerr << "***** Cannot use audio device " << device << "; falling back to default sound" << endl;
+		return;
+	}
+
+	m_audioMixer.reset(new AudioMixer);
+	m_audioMixer->setDevice(audioDevice);
+	string path = m_gw->assetPath();
+	const AssetPack* pack = m_gw->assetPack();
+	for (const auto& sound : m_soundMap)
+	{
+		AssetPack::Sound clip;
+		if (pack != nullptr)
+		{
+			if (!pack->findSound(sound.second, clip)  ||  clip.sampleRate != AudioMixer::SAMPLE_RATE)
+				cerr << "***** Asset pack has no " << AudioMixer::SAMPLE_RATE << " Hz sound " << sound.second << endl;
+			else
+				m_audioMixer->useClip(sound.first, clip.stereoFrames, clip.numFrames);
+		}
+		else if (!m_audioMixer->loadClip(sound.first, path + sound.second))
+			cerr << "***** Cannot decode sound: " << (path + sound.second) << endl;
+	}
+	m_audioMixer->start();
 }
 
-bool GameController::passesThruWhenSingleStepping(int key) const
+  // PEACH_METRICS_SOCKET serves live counters (see Metrics.h) on a Unix
+  // socket, e.g. read with nc -U; PEACH_METRICS_DUMP writes them to a file
+  // on SIGUSR1
+void GameController::initMetrics()
 {
-    static set<int> passThruKeys = {
-        'a', 'd', 'w', 's', KEY_PRESS_TAB, '`', KEY_PRESS_LEFT, KEY_PRESS_RIGHT,
-        KEY_PRESS_UP, KEY_PRESS_DOWN, KEY_PRESS_ENTER, '\\'
-    };
-    return passThruKeys.find(key) != passThruKeys.end();
+	const char* socketPath = getenv("PEACH_METRICS_SOCKET");
+	const char* dumpPath = getenv("PEACH_METRICS_DUMP");
+	if (socketPath != nullptr  &&  *socketPath != '\0')
+		m_metricsExporter.serve(socketPath);
+	if (dumpPath != nullptr  &&  *dumpPath != '\0')
+		m_metricsExporter.dumpOnSignal(dumpPath);
+}
+
+void GameController::stopAllSounds()
+{
+	if (m_audioMixer)
+		m_audioMixer->stopAll();
+	else
+		SoundFX().abortClip();
 }
 
 static void doSomethingCallback()
 {
+	Game().requestRedraw();
 	Game().doSomething();
 }
 
@@ -159,8 +208,17 @@ static void specialKeyboardEventCallback(int key, int x, int y)
 
 void GameController::timerFuncCallback(int)
 {
-	Game().doSomething();
-    glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
+	GameController& game = Game();
+	double now = PerfStats::nowMs();
+	if (game.m_lastTimerMs > 0)
+	{
+		long long dropped = game.m_perfStats.droppedFrames();
+		game.m_perfStats.recordFrameInterval(now - game.m_lastTimerMs);
+		Metrics::add(metric_frames_dropped, game.m_perfStats.droppedFrames() - dropped);
+	}
+	game.m_lastTimerMs = now;
+	game.doSomething();
+    glutTimerFunc(game.msUntilNextCallback(), timerFuncCallback, 0);
 }
 
 #if defined(__APPLE__)
@@ -173,12 +231,21 @@ void windowCloseCallback()
 void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTitle)
 {
 	gw->setController(this);
+	gw->soundBus().subscribe(this);
+	gw->soundBus().setCoalesceWindow(SOUND_COALESCE_TICKS);
 	m_gw = gw;
 	setGameState(welcome);
     m_singleStep = false;
+    m_stepRequested = false;
     m_postInitPreCleanup = false;
-	m_curIntraFrameTick = 0;
+	m_nextTickMs = 0;
+	m_redrawRequested = true;
 	m_winner = GWSTATUS_CONTINUE_GAME;
+	m_showPerfOverlay = false;
+	m_showHeatmap = false;
+	m_lastTimerMs = 0;
+	m_perfTextUpdatedMs = 0;
+	initMetrics();
 
 	glutInit(&argc, argv);
 
@@ -200,6 +267,9 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
 
 	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
 	glutMainLoop();
+	dumpPerfStatsIfRequested();
+	m_metricsExporter.stop();
+	m_audioMixer.reset();  // flushes any recording
 	delete m_gw;
     reportLeakedGraphObjects();
 }
@@ -209,13 +279,22 @@ void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
 	switch (key)
 	{
 		default:
-            m_keysHit.push_back(key);
+            submitKey(key);
             break;
 		case 'f':
             m_singleStep = true;
             break;
 		case 'r':
             m_singleStep = false;
+            break;
+		case 'p':
+            m_showPerfOverlay = !m_showPerfOverlay;
+            m_redrawRequested = true;
+            break;
+		case 'h':
+            m_showHeatmap = !m_showHeatmap;
+            m_gw->setHeatmapOverlay(m_showHeatmap);
+            m_redrawRequested = true;
             break;
 		case '\x03':  // CTRL-C
 		case KEY_PRESS_ESCAPE:
@@ -228,11 +307,82 @@ void GameController::specialKeyboardEvent(int key, int /* x */, int /* y */)
 {
 	switch (key)
 	{
-		case GLUT_KEY_LEFT:	 m_keysHit.push_back(KEY_PRESS_LEFT);  break;
-		case GLUT_KEY_RIGHT: m_keysHit.push_back(KEY_PRESS_RIGHT); break;
-		case GLUT_KEY_UP:	 m_keysHit.push_back(KEY_PRESS_UP);    break;
-		case GLUT_KEY_DOWN:	 m_keysHit.push_back(KEY_PRESS_DOWN);  break;
+		case GLUT_KEY_LEFT:	 submitKey(KEY_PRESS_LEFT);  break;
+		case GLUT_KEY_RIGHT: submitKey(KEY_PRESS_RIGHT); break;
+		case GLUT_KEY_UP:	 submitKey(KEY_PRESS_UP);    break;
+		case GLUT_KEY_DOWN:	 submitKey(KEY_PRESS_DOWN);  break;
+	}
+}
+
+  // Game keys go straight into the players' input rings while a game is in
+  // progress; everything else is for the controller itself
+void GameController::submitKey(int key)
+{
+	if (m_postInitPreCleanup  &&  m_gw->submitKey(key))
+	{
+		if (m_singleStep)
+			m_stepRequested = true;  // a game key also advances one step
+		return;
+	}
+	m_keysHit.push_back(key);
+}
+
+  // In single-step mode a tick waits for a key; otherwise for its deadline
+bool GameController::tickDue()
+{
+	if (m_nextStateAfterAnimate != not_applicable)
+		return false;
+	if (m_singleStep)
+	{
+		int key;
+		if (!m_stepRequested  &&  !getKeyIfAny(key))
+			return false;
+		m_stepRequested = false;
+		return true;
+	}
+	return PerfStats::nowMs() >= m_nextTickMs;
+}
+
+  // Runs one tick; false if play can't go on
+bool GameController::makeMove()
+{
+	m_nextStateAfterAnimate = not_applicable;
+	double start = PerfStats::nowMs();
+	int status = m_gw->move();
+	double end = PerfStats::nowMs();
+	m_perfStats.record(PerfStats::tick_time, end - start);
+	m_perfStats.countTick(end);
+
+	  // Deadlines advance a tick at a time; a late tick doesn't make the
+	  // next ones hurry to catch up
+	m_nextTickMs += m_ms_per_tick;
+	if (m_nextTickMs < start)
+		m_nextTickMs = start + m_ms_per_tick;
+
+	if (status == GWSTATUS_PEACH_WON  ||  status == GWSTATUS_YOSHI_WON)
+	{
+		m_winner = status;
+		m_nextStateAfterAnimate = gameover;
+	}
+	else if (status == GWSTATUS_NOT_IMPLEMENTED)
+	{
+		m_mainMessage = "Game not implemented!";
+		m_secondMessage = "Press ESC to quit...";
+		setGameState(prompt);
+		m_nextStateAfterPrompt = quit;
+		return false;
 	}
+	return true;
+}
+
+  // During play the timer fires when the next tick is due, so a tick isn't
+  // held up waiting for a frame's worth of timer
+int GameController::msUntilNextCallback() const
+{
+	if (m_gameState != animate  ||  m_singleStep)
+		return MS_PER_FRAME;
+	double wait = ceil(m_nextTickMs - PerfStats::nowMs());
+	return (wait < 0) ? 0 : (wait > MS_PER_FRAME) ? MS_PER_FRAME : static_cast<int>(wait);
 }
 
 void GameController::playSound(int soundID)
@@ -240,6 +390,12 @@ void GameController::playSound(int soundID)
 	if (soundID == SOUND_NONE)
 		return;
 
+	if (m_audioMixer)
+	{
+		m_audioMixer->play(soundID);
+		return;
+	}
+
 	auto p = m_soundMap.find(soundID);
 	if (p != m_soundMap.end())
 	{
@@ -268,44 +424,32 @@ void GameController::doSomething()
 			m_nextStateAfterPrompt = init;
 			break;
 		case makemove:
-			m_curIntraFrameTick = ANIMATION_POSITIONS_PER_TICK;
-			m_nextStateAfterAnimate = not_applicable;
+		case animate:
+			  // Ticks keep their own schedule, and a tick always runs before
+			  // the frame drawn in the same callback, so input never waits
+			  // behind rendering and its effect is drawn at once.  Frames
+			  // only change when a tick has run, so only then are they drawn
+			  // (or when a key changed the display).
+			if (m_gameState == makemove  ||  tickDue())
 			{
-				int status = m_gw->move();
-				if (status == GWSTATUS_PEACH_WON  ||  status == GWSTATUS_YOSHI_WON)
-				{
-					m_winner = status;
-					m_nextStateAfterAnimate = gameover;
-				}
-                else if (status == GWSTATUS_NOT_IMPLEMENTED)
-                {
-                    m_mainMessage = "Game not implemented!";
-                    m_secondMessage = "Press ESC to quit...";
-                    setGameState(prompt);
-                    m_nextStateAfterPrompt = quit;
-                    break;
-                }
+				if (!makeMove())
+					break;
+				setGameState(animate);
+				m_redrawRequested = true;
 			}
-			setGameState(animate);
-			break;
-		case animate:
-			displayGamePlay();
-			if (m_curIntraFrameTick-- <= 0)
+			if (m_redrawRequested)
 			{
-				if (m_nextStateAfterAnimate != not_applicable)
-					setGameState(m_nextStateAfterAnimate);
-				else if (!m_singleStep)
-                    setGameState(makemove);
-                else {
-                    int key;
-                    if (getKeyIfAny(key))
-                    {
-                        if (passesThruWhenSingleStepping(key))
-                            putBackKey(key);
-                        setGameState(makemove);
-                    }
-                }
+				m_redrawRequested = false;
+				double start = PerfStats::nowMs();
+				displayGamePlay();
+				double end = PerfStats::nowMs();
+				m_perfStats.record(PerfStats::render_time, end - start);
+				m_perfStats.countFrame(end);
+				Metrics::add(metric_frames);
+				m_gw->inputShown();
 			}
+			if (m_nextStateAfterAnimate != not_applicable)
+				setGameState(m_nextStateAfterAnimate);
 			break;
 		case cleanup:
             if (m_postInitPreCleanup)  // should always be true here
@@ -341,7 +485,7 @@ void GameController::doSomething()
 			{
 				int status = m_gw->init();
                 m_postInitPreCleanup = true;
-				SoundFX().abortClip();
+				stopAllSounds();
                 switch (status)
                 {
                   case GWSTATUS_CONTINUE_GAME:
@@ -373,7 +517,7 @@ void GameController::doSomething()
                 m_gw->cleanUp();
                 m_postInitPreCleanup = false;
             }
-            SoundFX().abortClip();
+            stopAllSounds();
 			glutLeaveMainLoop();
 			break;
 	}
@@ -404,13 +548,34 @@ void GameController::displayGamePlay()
 				int angle = cur->getDirection();
 				int imageID = cur->getID();
 
-				m_spriteManager.plotSprite(imageID, cur->getAnimationNumber() % m_spriteManager.getNumFrames(imageID), gx, gy, gz, angle, cur->getSize());
+				m_spriteManager.plotSprite(imageID, cur->getAnimationNumber() % m_spriteManager.getNumFrames(imageID), gx, gy, gz, angle, cur->getSize(), cur->getBrightness());
 			}
 		}
 	}
 
 	drawScoreAndLives(m_gameStatText);
 
+	if (m_showPerfOverlay)
+	{
+		  // Percentiles aren't free, so refresh the text a few times a second
+		double now = PerfStats::nowMs();
+		if (now - m_perfTextUpdatedMs >= PERF_TEXT_REFRESH_MS)
+		{
+			m_perfText = m_perfStats.summary();
+			const InputLatency& latency = m_gw->inputLatency();
+			if (latency.count(source_keyboard, InputLatency::stage_shown) > 0)
+			{
+				ostringstream oss;
+				oss << fixed << setprecision(0) << " | Key to screen p50: "
+				    << latency.percentileMs(source_keyboard, 50, InputLatency::stage_shown) << "ms p99: "
+				    << latency.percentileMs(source_keyboard, 99, InputLatency::stage_shown) << "ms";
+				m_perfText += oss.str();
+			}
+			m_perfTextUpdatedMs = now;
+		}
+		drawPerfOverlay(m_perfText);
+	}
+
 	glutSwapBuffers();
 }
 
@@ -433,8 +598,25 @@ void GameController::reportLeakedGraphObjects() const
         cout << "***** Total leaked objects: " << totalLeaked << endl;
 }
 
+void GameController::dumpPerfStatsIfRequested() const
+{
+	const char* path = getenv("PEACH_PERF_LOG");
+	if (path == nullptr  ||  *path == '\0')
+		return;
+	if (m_perfStats.dump(path))
+	{
+		ofstream out(path, ios::app);
+		out << "# " << m_gw->inputLatency().summary() << "\n";
+		m_gw->inputLatency().writeHistograms(out);
+		cout << "Performance statistics written to " << path << endl;
+	}
+	else
+		cerr << "***** Unable to write performance statistics to " << path << endl;
+}
+
 void GameController::reshape (int w, int h)
 {
+    m_redrawRequested = true;
     glViewport (0, 0, (GLsizei) w, (GLsizei) h);
     glMatrixMode (GL_PROJECTION);
     glLoadIdentity ();
@@ -451,46 +633,24 @@ static void convertToGlutCoords(double x, double y, double& gx, double& gy, doub
 	gz = .6 * VISIBLE_MIN_Z;
 }
 
-static void doOutputStroke(double x, double y, double z, double size, const char* str, bool centered)
+static void outputStrokeCentered(StrokeTextLine& line, double y, double z, const string& str)
 {
-	if (centered)
-	{
-		double len = glutStrokeLength(GLUT_STROKE_ROMAN, reinterpret_cast<const unsigned char*>(str)) / FONT_SCALEDOWN;
-		x = -len / 2;
-		size = 1;
-	}
-	GLfloat scaledSize = static_cast<GLfloat>(size / FONT_SCALEDOWN);
-	glPushMatrix();
-	glLineWidth(1);
-	glLoadIdentity();
-	glTranslatef(static_cast<GLfloat>(x), static_cast<GLfloat>(y), static_cast<GLfloat>(z));
-	glScalef(scaledSize, scaledSize, scaledSize);
-	for ( ; *str != '\0'; str++)
-		glutStrokeCharacter(GLUT_STROKE_ROMAN, *str);
-	glPopMatrix();
+	line.drawCentered(y, z, FONT_SCALEDOWN, str);
 }
 
-//static void outputStroke(double x, double y, double z, double size, const char* str)
-//{
-//	doOutputStroke(x, y, z, size, str, false);
-//}
-
-static void outputStrokeCentered(double y, double z, const char* str)
-{
-	doOutputStroke(0, y, z, 1, str, true);
-}
-
-static void drawPrompt(string mainMessage, string secondMessage)
+static void drawPrompt(const string& mainMessage, const string& secondMessage)
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glColor3f (1.0, 1.0, 1.0);
 	glLoadIdentity ();
-	outputStrokeCentered(1, -5, mainMessage.c_str());
-	outputStrokeCentered(-1, -5, secondMessage.c_str());
+	static StrokeTextLine mainLine;
+	static StrokeTextLine secondLine;
+	outputStrokeCentered(mainLine, 1, -5, mainMessage);
+	outputStrokeCentered(secondLine, -1, -5, secondMessage);
 	glutSwapBuffers();
 }
 
-static void drawScoreAndLives(string gameStatText)
+static void drawScoreAndLives(const string& gameStatText)
 {
 	static int RATE = 1;
 	static GLfloat rgb[3] =
@@ -505,7 +665,15 @@ static void drawScoreAndLives(string gameStatText)
 		rgb[k] = static_cast<GLfloat>(strength);
 	}
 	glColor3f(rgb[0], rgb[1], rgb[2]);
-	outputStrokeCentered(SCORE_Y, SCORE_Z, gameStatText.c_str()); // GAME DISPLAY LOCATION
+	static StrokeTextLine statLine;
+	outputStrokeCentered(statLine, SCORE_Y, SCORE_Z, gameStatText); // GAME DISPLAY LOCATION
+}
+
+static void drawPerfOverlay(const string& perfText)
+{
+	glColor3f(1.0, 1.0, 0.4);
+	static StrokeTextLine perfLine;
+	outputStrokeCentered(perfLine, PERF_OVERLAY_Y, SCORE_Z, perfText);
 }
 
 #if defined(__APPLE__)
@@ -2,6 +2,10 @@
 #define GAMECONTROLLER_H_
 
 #include "SpriteManager.h"
+#include "PerfStats.h"
+#include "Metrics.h"
+#include "AudioMixer.h"
+#include "SoundBus.h"
 #include <string>
 #include <map>
 #include <queue>
@@ -11,7 +15,7 @@
 class GraphObject;
 class GameWorld;
 
-class GameController
+class GameController : public SoundListener
 {
   public:
 	void run(int argc, char* argv[], GameWorld* gw, std::string windowTitle);
@@ -31,6 +35,10 @@ class GameController
 	}
 
 	void playSound(int soundID);
+	virtual void onSound(const SoundEvent& event)
+	{
+		playSound(event.soundID);
+	}
 
 	void setGameStatText(std::string text)
 	{
@@ -38,6 +46,7 @@ class GameController
 	}
 
 	void doSomething();
+	void requestRedraw() { m_redrawRequested = true; }
 
 	void reshape(int w, int h);
 	void keyboardEvent(unsigned char key, int x, int y);
@@ -68,24 +77,41 @@ private:
 	GameControllerState m_nextStateAfterAnimate;
 	std::deque<int> m_keysHit;
 	bool        m_singleStep;
+	bool        m_stepRequested;
     bool        m_postInitPreCleanup;
 	std::string m_gameStatText;
 	std::string m_mainMessage;
 	std::string m_secondMessage;
-	int	        m_curIntraFrameTick;
+	double      m_nextTickMs;
+	bool        m_redrawRequested;
 	int         m_winner;
 	std::map<int, std::string> m_soundMap;
+	std::unique_ptr<AudioMixer> m_audioMixer;
 	std::map<int, std::string> m_imageNameMap;
 	std::map<int, KeyMapInfo> m_keyMap;
 	SpriteManager m_spriteManager;
+	PerfStats   m_perfStats;
+	MetricsExporter m_metricsExporter;
+	bool        m_showPerfOverlay;
+	bool        m_showHeatmap;
+	double      m_lastTimerMs;
+	double      m_perfTextUpdatedMs;
+	std::string m_perfText;
 
 	void setGameState(GameControllerState s);
 	void initDrawersAndSounds();
-	bool passesThruWhenSingleStepping(int key) const;
+	void initAudioMixer();
+	void initMetrics();
+	void stopAllSounds();
+	void submitKey(int key);
+	bool tickDue();
+	bool makeMove();
+	int  msUntilNextCallback() const;
 	void displayGamePlay();
 	void reportLeakedGraphObjects() const;
+	void dumpPerfStatsIfRequested() const;
 
-	static const int kDefaultMsPerTick = 10;
+	static const int kDefaultMsPerTick = 15;
 	static int m_ms_per_tick;
 };
 
@@ -5,38 +5,35 @@ using namespace std;
 
 int GameWorld::getAction(int playerNum)
 {
-    queue<int>& pendingActions = m_pendingActions[playerNum-1];
-    if (!pendingActions.empty())
-    {
-        int action = pendingActions.front();
-        pendingActions.pop();
-        return action;
-    }
-    int key;
-    while (m_controller->getKeyIfAny(key))
-    {
-        auto it = m_keyMap.find(key);
-        if (it == m_keyMap.end())  // meaningless key
-            continue;
-        const KeyInfo& keyInfo = it->second;
-        if (keyInfo.playerNum == playerNum)
-            return keyInfo.action;
-        m_pendingActions[keyInfo.playerNum-1].push(keyInfo.action);
-    }
-    return ACTION_NONE;
+    ActionEvent event;
+    if (!m_actionRings[playerNum-1]->pop(event))
+        return ACTION_NONE;
+    m_inputLatency.record(event.source, inputClockNs() - event.timestampNs);
+    if (m_controller != nullptr)
+        m_unshownActions.push_back(event);
+    if (m_actionLog != nullptr)
+        m_actionLog->record(m_tickCount, playerNum, event.action);
+    return event.action;
 }
 
-void GameWorld::playSound(int soundID)
+void GameWorld::inputShown()
 {
-	m_controller->playSound(soundID);
+    if (m_unshownActions.empty())
+        return;
+    long long now = inputClockNs();
+    for (const ActionEvent& event : m_unshownActions)
+        m_inputLatency.record(event.source, now - event.timestampNs, InputLatency::stage_shown);
+    m_unshownActions.clear();
 }
 
 void GameWorld::setGameStatText(string text)
 {
-	m_controller->setGameStatText(text);
+	if (m_controller != nullptr)
+		m_controller->setGameStatText(text);
 }
 
 void GameWorld::setMsPerTick(int ms_per_tick)
 {
-	m_controller->setMsPerTick(ms_per_tick);
+	if (m_controller != nullptr)
+		m_controller->setMsPerTick(ms_per_tick);
 }
@@ -2,12 +2,16 @@
 #define GAMEWORLD_H_
 
 #include "GameConstants.h"
-#include <map>
+#include "SoundBus.h"
+#include "SpscQueue.h"
+#include "InputPipeline.h"
 #include <string>
-#include <queue>
 #include <chrono>
+#include <vector>
+#include <memory>
 
 class GameController;
+class AssetPack;
 
 class GameWorld
 {
@@ -15,22 +19,29 @@ public:
 
 	GameWorld(std::string assetPath)
 	 : m_stars(0), m_coins(0), m_boardNumber(1), m_controller(nullptr),
-	   m_assetPath(assetPath)
-	{
-		m_keyMap = {
-			{ 'a',             { 1, ACTION_LEFT } },
-			{ 'd',             { 1, ACTION_RIGHT } },
-			{ 'w',             { 1, ACTION_UP } },
-			{ 's',             { 1, ACTION_DOWN } },
-			{ KEY_PRESS_TAB,   { 1, ACTION_ROLL } },
-			{ '`',             { 1, ACTION_FIRE } },
-			{ KEY_PRESS_LEFT,  { 2, ACTION_LEFT } },
-			{ KEY_PRESS_RIGHT, { 2, ACTION_RIGHT } },
-			{ KEY_PRESS_UP,    { 2, ACTION_UP } },
-			{ KEY_PRESS_DOWN,  { 2, ACTION_DOWN } },
-			{ KEY_PRESS_ENTER, { 2, ACTION_ROLL } },
-			{ '\\',            { 2, ACTION_FIRE } },
+	   m_assetPath(assetPath), m_tickCount(0), m_tickClockMs(0),
+	   m_countdownTickDeadline(0), m_actionLog(nullptr), m_assetPack(nullptr)
+	{
+		setNumPlayers(2);
+
+		const KeyBinding bindings[] = {
+			{ 'a',             1, ACTION_LEFT },
+			{ 'd',             1, ACTION_RIGHT },
+			{ 'w',             1, ACTION_UP },
+			{ 's',             1, ACTION_DOWN },
+			{ KEY_PRESS_TAB,   1, ACTION_ROLL },
+			{ '`',             1, ACTION_FIRE },
+			{ KEY_PRESS_LEFT,  2, ACTION_LEFT },
+			{ KEY_PRESS_RIGHT, 2, ACTION_RIGHT },
+			{ KEY_PRESS_UP,    2, ACTION_UP },
+			{ KEY_PRESS_DOWN,  2, ACTION_DOWN },
+			{ KEY_PRESS_ENTER, 2, ACTION_ROLL },
+			{ '\\',            2, ACTION_FIRE },
 		};
+		for (int i = 0; i < KEY_TABLE_SIZE; i++)
+			m_keyTable[i] = KeyInfo{ 0, ACTION_NONE };
+		for (const KeyBinding& b : bindings)
+			m_keyTable[keyIndex(b.key)] = KeyInfo{ b.playerNum, b.action };
 
 		if (!m_assetPath.empty()  &&  m_assetPath.back() != '/')
 			m_assetPath.push_back('/');
@@ -44,10 +55,31 @@ public:
 	virtual int move() = 0;
 	virtual void cleanUp() = 0;
 
+	  // Tint the board to show where play happens; worlds that don't keep
+	  // such statistics ignore this
+	virtual void setHeatmapOverlay(bool /* show */)
+	{
+	}
+
 	void setGameStatText(std::string text);
 
+	int getNumPlayers() const
+	{
+		return static_cast<int>(m_actionRings.size());
+	}
+
 	int getAction(int playerNum);
-	void playSound(int soundID);
+
+	void playSound(int soundID)
+	{
+		m_soundBus.emit(m_tickCount, soundID);
+	}
+
+	  // Subscribe to hear this world's sounds (the controller, a recorder, ...)
+	SoundBus& soundBus()
+	{
+		return m_soundBus;
+	}
 
 	int getBoardNumber() const
 	{
@@ -64,19 +96,55 @@ public:
 	{
 		m_countdownTimerDeadline = std::chrono::system_clock::now() +
 			std::chrono::seconds(numSeconds);
+		if (m_tickClockMs > 0)
+			m_countdownTickDeadline = m_tickCount + numSeconds * 1000LL / m_tickClockMs;
 	}
 
 	int timeRemaining() const
 	{
+		if (m_tickClockMs > 0)
+			return static_cast<int>((m_countdownTickDeadline - m_tickCount) * m_tickClockMs / 1000);
 		auto dur = m_countdownTimerDeadline - std::chrono::system_clock::now();
 		return static_cast<int>(dur.count() / decltype(dur)::period::den);
 	}
 
+	  // Call once at the start of every move()
+	void advanceTick()
+	{
+		m_tickCount++;
+	}
+
+	  // Moves the clock over ticks in which nothing happens
+	void skipTicks(long long numTicks)
+	{
+		m_tickCount += numTicks;
+	}
+
+	  // With the tick clock, the first tick on which timeRemaining() is no
+	  // longer positive; -1 on the real-time clock
+	long long countdownEndTick() const
+	{
+		if (m_tickClockMs <= 0)
+			return -1;
+		return m_countdownTickDeadline - 999 / m_tickClockMs;
+	}
+
+	long long getTickCount() const
+	{
+		return m_tickCount;
+	}
+
 	std::string assetPath() const
 	{
 		return m_assetPath;
 	}
 
+	  // If set, assets come from this pack rather than files in assetPath()
+	const AssetPack* assetPack() const
+	{
+		return m_assetPack;
+	}
+
 	  // The following should be used by only the framework, not the student
 
 	void setBoardNumber(int boardNumber)
@@ -89,6 +157,11 @@ public:
 		m_controller = controller;
 	}
 
+	void setAssetPack(const AssetPack* pack)
+	{
+		m_assetPack = pack;
+	}
+
 	int getWinnerStars() const
 	{
 		return m_stars;
@@ -101,22 +174,110 @@ public:
 
 	void setMsPerTick(int ms_per_tick);
 
+	  // Call before init(); the keyboard only ever drives players 1 and 2
+	void setNumPlayers(int numPlayers)
+	{
+		if (numPlayers < 2)
+			numPlayers = 2;
+		if (numPlayers > MAX_PLAYERS)
+			numPlayers = MAX_PLAYERS;
+		m_actionRings.clear();
+		for (int i = 0; i < numPlayers; i++)
+			m_actionRings.emplace_back(new ActionRing);
+	}
+
+	  // Headless drivers have no controller: they run the countdown on
+	  // simulated time and feed actions to the players directly.
+
+	void useTickClock(int msPerTick)
+	{
+		m_tickClockMs = msPerTick;
+	}
+
+	  // Each player has a single-producer ring of timestamped actions, fed by
+	  // the keyboard, a bot, a replay or a script.  Returns false if full.
+	bool submitAction(int playerNum, int action, int source)
+	{
+		return m_actionRings[playerNum-1]->push(ActionEvent{ action, source, inputClockNs() });
+	}
+
+	bool hasPendingAction(int playerNum) const
+	{
+		return !m_actionRings[playerNum-1]->empty();
+	}
+
+	  // Routes a game key to its player's ring; false if it isn't a game key
+	bool submitKey(int key)
+	{
+		int index = keyIndex(key);
+		if (index < 0  ||  m_keyTable[index].playerNum == 0)
+			return false;
+		const KeyInfo& keyInfo = m_keyTable[index];
+		submitAction(keyInfo.playerNum, keyInfo.action, source_keyboard);
+		return true;
+	}
+
+	const InputLatency& inputLatency() const
+	{
+		return m_inputLatency;
+	}
+
+	  // The controller calls this once it has drawn a frame after a move(),
+	  // completing the latency of the actions consumed since the last one
+	void inputShown();
+
+	  // Every consumed action is appended to log, if set (for replays)
+	void setActionLog(ActionLog* log)
+	{
+		m_actionLog = log;
+	}
+
 private:
 	struct KeyInfo
 	{
+		int playerNum;  // 0 if the key does nothing in the game
+		int action;
+	};
+
+	struct KeyBinding
+	{
+		int key;
 		int playerNum;
 		int action;
 	};
 
+	  // Plain keys index directly; the arrow keys follow them
+	static const int KEY_TABLE_SIZE = 256 + (KEY_PRESS_DOWN - KEY_PRESS_LEFT + 1);
+
+	static int keyIndex(int key)
+	{
+		if (key >= 0  &&  key < 256)
+			return key;
+		if (key >= KEY_PRESS_LEFT  &&  key <= KEY_PRESS_DOWN)
+			return 256 + key - KEY_PRESS_LEFT;
+		return -1;
+	}
+
+	static const int ACTION_RING_SIZE = 64;
+	typedef SpscQueue<ActionEvent, ACTION_RING_SIZE> ActionRing;
+
 	int             m_lives;
 	int             m_stars;
 	int             m_coins;
 	int             m_boardNumber;
 	GameController* m_controller;
-	std::queue<int> m_pendingActions[2];  // 0 for Peach, 1 for Yoshi
+	std::vector<std::unique_ptr<ActionRing>> m_actionRings;  // indexed by player number - 1
 	std::string     m_assetPath;
-	std::map<int, KeyInfo> m_keyMap;
+	KeyInfo         m_keyTable[KEY_TABLE_SIZE];
 	std::chrono::system_clock::time_point m_countdownTimerDeadline;
+	long long       m_tickCount;
+	int             m_tickClockMs;
+	long long       m_countdownTickDeadline;
+	SoundBus        m_soundBus;
+	InputLatency    m_inputLatency;
+	std::vector<ActionEvent> m_unshownActions;  // consumed, not yet drawn
+	ActionLog*      m_actionLog;
+	const AssetPack* m_assetPack;
 };
 
 #endif // GAMEWORLD_H_
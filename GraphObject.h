@@ -26,13 +26,15 @@ class GraphObject
         if (m_size <= 0)
             m_size = 1;
 
-        getGraphObjects(m_depth).insert(this);
+        if (WorldPolicy::registerSprites)
+            getGraphObjects(m_depth).insert(this);
         setVisible(true);
     }
 
     virtual ~GraphObject()
     {
-        getGraphObjects(m_depth).erase(this);
+        if (WorldPolicy::registerSprites)
+            getGraphObjects(m_depth).erase(this);
     }
 
     int getX() const
@@ -168,6 +170,7 @@ class GraphObject
 
 private:
     friend class GameController;
+    friend class SoftwareRenderer;
     int getID() const
     {
         return m_imageID;
@@ -0,0 +1,112 @@
+#include "Heatmap.h"
+#include <fstream>
+using namespace std;
+
+static const char* const EVENT_NAMES[NUM_HEAT_EVENTS] = {
+    "coins_given", "coins_taken", "stars_bought", "bank_deposits",
+    "bank_withdrawals", "event_squares", "droppings", "bowser_robberies", "boo_swaps"
+};
+
+const char* heatEventName(HeatEvent event)
+{
+    return EVENT_NAMES[event];
+}
+
+SquareHeatmap::SquareHeatmap()
+{
+    clear();
+}
+
+void SquareHeatmap::clear()
+{
+    for (int c = 0; c < NUM_CELLS; c++)
+    {
+        m_passes[c] = 0;
+        m_landings[c] = 0;
+        for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+            m_events[e][c] = 0;
+    }
+}
+
+void SquareHeatmap::countPass(int cellX, int cellY)
+{
+    m_passes[cell(cellX, cellY)]++;
+}
+
+void SquareHeatmap::countLanding(int cellX, int cellY)
+{
+    m_landings[cell(cellX, cellY)]++;
+}
+
+void SquareHeatmap::countEvent(HeatEvent event, int cellX, int cellY)
+{
+    m_events[event][cell(cellX, cellY)]++;
+}
+
+unsigned int SquareHeatmap::passes(int cellX, int cellY) const
+{
+    return m_passes[cell(cellX, cellY)];
+}
+
+unsigned int SquareHeatmap::landings(int cellX, int cellY) const
+{
+    return m_landings[cell(cellX, cellY)];
+}
+
+unsigned int SquareHeatmap::events(HeatEvent event, int cellX, int cellY) const
+{
+    return m_events[event][cell(cellX, cellY)];
+}
+
+unsigned int SquareHeatmap::maxVisits() const
+{
+    unsigned int most = 0;
+    for (int c = 0; c < NUM_CELLS; c++)
+    {
+        if (m_passes[c] + m_landings[c] > most)
+            most = m_passes[c] + m_landings[c];
+    }
+    return most;
+}
+
+void SquareHeatmap::merge(const SquareHeatmap& other)
+{
+    for (int c = 0; c < NUM_CELLS; c++)
+    {
+        m_passes[c] += other.m_passes[c];
+        m_landings[c] += other.m_landings[c];
+        for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+            m_events[e][c] += other.m_events[e][c];
+    }
+}
+
+bool SquareHeatmap::save(const string& filename, const string& comment) const
+{
+    ofstream out(filename);
+    if (!out)
+        return false;
+    if (!comment.empty())
+        out << "# " << comment << "\n";
+    out << "x,y,passes,landings";
+    for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+        out << "," << EVENT_NAMES[e];
+    out << "\n";
+    for (int c = 0; c < NUM_CELLS; c++)
+    {
+        bool any = (m_passes[c] != 0 || m_landings[c] != 0);
+        for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+            any = any || m_events[e][c] != 0;
+        if (!any)
+            continue;
+        out << c % BOARD_WIDTH << "," << c / BOARD_WIDTH << "," << m_passes[c] << "," << m_landings[c];
+        for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+            out << "," << m_events[e][c];
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+int SquareHeatmap::cell(int cellX, int cellY)
+{
+    return cellY * BOARD_WIDTH + cellX;
+}
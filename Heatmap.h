@@ -0,0 +1,49 @@
+#ifndef HEATMAP_H_
+#define HEATMAP_H_
+
+#include "GameConstants.h"
+#include <string>
+
+// Square effects and enemy encounters counted per cell
+enum HeatEvent {
+    heat_coins_given, heat_coins_taken, heat_star_bought, heat_bank_deposit,
+    heat_bank_withdrawal, heat_event_square, heat_dropping, heat_bowser_robbery,
+    heat_boo_swap, NUM_HEAT_EVENTS
+};
+
+// Short snake_case name, as used for CSV column headings
+const char* heatEventName(HeatEvent event);
+
+// How often each cell of one board was walked over, landed on, and what
+// happened there.  Every world fills its own, so counting is a plain
+// increment; batch runs merge them when the games are done.
+class SquareHeatmap
+{
+public:
+    SquareHeatmap();
+    void clear();
+    
+    // Cells are board coordinates, not pixels
+    void countPass(int cellX, int cellY);
+    void countLanding(int cellX, int cellY);
+    void countEvent(HeatEvent event, int cellX, int cellY);
+    
+    unsigned int passes(int cellX, int cellY) const;
+    unsigned int landings(int cellX, int cellY) const;
+    unsigned int events(HeatEvent event, int cellX, int cellY) const;
+    unsigned int maxVisits() const;
+    
+    void merge(const SquareHeatmap& other);
+    
+    // One CSV line per cell where anything happened
+    bool save(const std::string& filename, const std::string& comment = "") const;
+private:
+    static const int NUM_CELLS = BOARD_WIDTH * BOARD_HEIGHT;
+    unsigned int m_passes[NUM_CELLS];
+    unsigned int m_landings[NUM_CELLS];
+    unsigned int m_events[NUM_HEAT_EVENTS][NUM_CELLS];
+    
+    static int cell(int cellX, int cellY);
+};
+
+#endif // HEATMAP_H_
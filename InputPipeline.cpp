@@ -0,0 +1,219 @@
+#include "InputPipeline.h"
+#include "GameWorld.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+using namespace std;
+
+static const char* const SOURCE_NAMES[NUM_ACTION_SOURCES] = {
+    "keyboard", "bot", "replay", "script"
+};
+
+static const char* const STAGE_NAMES[InputLatency::NUM_STAGES] = {
+    "consumed", "shown"
+};
+
+// INPUT LATENCY IMPLEMENTATION
+
+InputLatency::InputLatency()
+{
+    for (int stage = 0; stage < NUM_STAGES; stage++)
+    {
+        for (int i = 0; i < NUM_ACTION_SOURCES; i++)
+        {
+            Series& series = m_series[stage][i];
+            series.count = 0;
+            series.totalNs = 0;
+            series.maxNs = 0;
+            fill(begin(series.buckets), end(series.buckets), 0);
+        }
+    }
+}
+
+void InputLatency::record(int source, long long latencyNs, int stage)
+{
+    Series& series = m_series[stage][source];
+    series.count++;
+    series.totalNs += latencyNs;
+    if (latencyNs > series.maxNs)
+        series.maxNs = latencyNs;
+    int bucket = 0;
+    for (long long us = latencyNs / 1000; us > 0 && bucket < NUM_BUCKETS - 1; us >>= 1)
+        bucket++;
+    series.buckets[bucket]++;
+}
+
+long long InputLatency::count(int source, int stage) const
+{
+    return m_series[stage][source].count;
+}
+
+double InputLatency::meanMs(int source, int stage) const
+{
+    const Series& series = m_series[stage][source];
+    return (series.count == 0) ? 0 : series.totalNs / 1e6 / series.count;
+}
+
+double InputLatency::maxMs(int source, int stage) const
+{
+    return m_series[stage][source].maxNs / 1e6;
+}
+
+double InputLatency::percentileMs(int source, double p, int stage) const
+{
+    const Series& series = m_series[stage][source];
+    if (series.count == 0)
+        return 0;
+    long long rank = static_cast<long long>(p / 100 * (series.count - 1) + 0.5);
+    int bucket = 0;
+    for (long long seen = series.buckets[0]; seen <= rank && bucket < NUM_BUCKETS - 1; seen += series.buckets[++bucket])
+        ;
+    return min(static_cast<double>(1LL << bucket) / 1000, maxMs(source, stage));
+}
+
+long long InputLatency::bucketCount(int source, int bucket, int stage) const
+{
+    return m_series[stage][source].buckets[bucket];
+}
+
+string InputLatency::summary() const
+{
+    ostringstream oss;
+    oss << fixed << setprecision(2);
+    for (int i = 0; i < NUM_ACTION_SOURCES; i++)
+    {
+        if (count(i) == 0)
+            continue;
+        if (oss.tellp() > 0)
+            oss << " | ";
+        oss << SOURCE_NAMES[i] << " input: " << count(i) << " actions, mean "
+            << meanMs(i) << "ms, p50 " << percentileMs(i, 50) << "ms, p99 " << percentileMs(i, 99)
+            << "ms, max " << maxMs(i) << "ms";
+        if (count(i, stage_shown) > 0)
+            oss << "; shown p50 " << percentileMs(i, 50, stage_shown) << "ms, p99 "
+                << percentileMs(i, 99, stage_shown) << "ms";
+    }
+    return oss.str();
+}
+
+void InputLatency::writeHistograms(ostream& out) const
+{
+    out << "stage,source,under_ms,count\n";
+    for (int stage = 0; stage < NUM_STAGES; stage++)
+    {
+        for (int i = 0; i < NUM_ACTION_SOURCES; i++)
+        {
+            for (int b = 0; b < NUM_BUCKETS; b++)
+            {
+                long long n = bucketCount(i, b, stage);
+                if (n > 0)
+                    out << STAGE_NAMES[stage] << "," << SOURCE_NAMES[i] << ","
+                        << static_cast<double>(1LL << b) / 1000 << "," << n << "\n";
+            }
+        }
+    }
+}
+
+// ACTION LOG IMPLEMENTATION
+
+void ActionLog::record(long long tick, int playerNum, int action)
+{
+    m_actions.push_back(ConsumedAction{ tick, playerNum, action });
+}
+
+void ActionLog::recordComment(long long tick, const string& lines)
+{
+    m_comments.push_back(Comment{ tick, lines });
+}
+
+const vector<ConsumedAction>& ActionLog::actions() const
+{
+    return m_actions;
+}
+
+void ActionLog::clear()
+{
+    m_actions.clear();
+    m_comments.clear();
+}
+
+bool ActionLog::save(const string& filename) const
+{
+    ofstream out(filename);
+    if (!out)
+        return false;
+    // Both lists are in tick order
+    size_t c = 0;
+    for (const ConsumedAction& a : m_actions)
+    {
+        for (; c < m_comments.size() && m_comments[c].tick < a.tick; c++)
+            out << m_comments[c].lines;
+        out << a.tick << "," << a.playerNum << "," << a.action << "\n";
+    }
+    for (; c < m_comments.size(); c++)
+        out << m_comments[c].lines;
+    return static_cast<bool>(out);
+}
+
+// ACTION SCRIPT IMPLEMENTATION
+
+ActionScript::ActionScript(int source)
+{
+    m_source = source;
+    m_next = 0;
+}
+
+bool ActionScript::load(const string& filename)
+{
+    ifstream in(filename);
+    if (!in)
+        return false;
+    m_actions.clear();
+    string line;
+    while (getline(in, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        ConsumedAction a;
+        char comma1, comma2;
+        istringstream iss(line);
+        if (!(iss >> a.tick >> comma1 >> a.playerNum >> comma2 >> a.action) || comma1 != ',' || comma2 != ',')
+            return false;
+        m_actions.push_back(a);
+    }
+    stable_sort(m_actions.begin(), m_actions.end(),
+                [](const ConsumedAction& a, const ConsumedAction& b) { return a.tick < b.tick; });
+    m_next = 0;
+    return true;
+}
+
+bool ActionScript::controlsPlayer(int playerNum) const
+{
+    for (const ConsumedAction& a : m_actions)
+        if (a.playerNum == playerNum)
+            return true;
+    return false;
+}
+
+void ActionScript::feed(GameWorld& world)
+{
+    long long tick = world.getTickCount() + 1;
+    while (m_next < m_actions.size() && m_actions[m_next].tick <= tick)
+    {
+        const ConsumedAction& a = m_actions[m_next++];
+        world.submitAction(a.playerNum, a.action, m_source);
+    }
+}
+
+long long ActionScript::nextTick() const
+{
+    if (m_next >= m_actions.size())
+        return -1;
+    return m_actions[m_next].tick;
+}
+
+void ActionScript::rewind()
+{
+    m_next = 0;
+}
@@ -0,0 +1,116 @@
+#ifndef INPUTPIPELINE_H_
+#define INPUTPIPELINE_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <chrono>
+
+// Where a player's action came from
+enum ActionSource {
+    source_keyboard, source_bot, source_replay, source_script, NUM_ACTION_SOURCES
+};
+
+// One action waiting in a player's input ring
+struct ActionEvent
+{
+    int action;
+    int source;
+    long long timestampNs;  // when it entered the ring, on inputClockNs()
+};
+
+inline long long inputClockNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// How long actions took, per source, from submission (for keys, the
+// keyboard callback) to being consumed by a player and to the first frame
+// drawn after that.  Each stage keeps a histogram with power-of-two buckets,
+// so recording is O(1) and percentiles are good to a factor of two.
+class InputLatency
+{
+public:
+    enum Stage {
+        stage_consumed, stage_shown, NUM_STAGES
+    };
+    // Bucket b holds latencies under 2^b microseconds (and at least half
+    // that); the last also holds everything longer
+    static const int NUM_BUCKETS = 25;
+
+    InputLatency();
+    void record(int source, long long latencyNs, int stage = stage_consumed);
+    long long count(int source, int stage = stage_consumed) const;
+    double meanMs(int source, int stage = stage_consumed) const;
+    double maxMs(int source, int stage = stage_consumed) const;
+    // The upper end of the bucket holding the p-th percentile
+    double percentileMs(int source, double p, int stage = stage_consumed) const;
+    long long bucketCount(int source, int bucket, int stage = stage_consumed) const;
+    std::string summary() const;
+    // "stage,source,under_ms,count" lines for the non-empty buckets
+    void writeHistograms(std::ostream& out) const;
+private:
+    struct Series
+    {
+        long long count;
+        long long totalNs;
+        long long maxNs;
+        long long buckets[NUM_BUCKETS];
+    };
+
+    Series m_series[NUM_STAGES][NUM_ACTION_SOURCES];
+};
+
+// An action as the simulation consumed it
+struct ConsumedAction
+{
+    long long tick;
+    int playerNum;
+    int action;
+};
+
+// Records consumed actions; saved as one "tick,player,action" line each.
+// Comment lines recorded with recordComment() (state hashes, see
+// StateHash.h) are saved after the actions of their tick.
+class ActionLog
+{
+public:
+    void record(long long tick, int playerNum, int action);
+    void recordComment(long long tick, const std::string& lines);
+    const std::vector<ConsumedAction>& actions() const;
+    void clear();
+    bool save(const std::string& filename) const;
+private:
+    struct Comment
+    {
+        long long tick;
+        std::string lines;     // each starting with '#'
+    };
+
+    std::vector<ConsumedAction> m_actions;
+    std::vector<Comment> m_comments;
+};
+
+class GameWorld;
+
+// Feeds a saved action log (a replay) or a hand-written script of the same
+// format into a world, each action arriving on the tick it names.
+class ActionScript
+{
+public:
+    ActionScript(int source = source_replay);
+    bool load(const std::string& filename);
+    bool controlsPlayer(int playerNum) const;
+    // Call before each move(); submits the actions for the coming tick
+    void feed(GameWorld& world);
+    // The tick of the next action to feed, or -1 once all have been fed
+    long long nextTick() const;
+    void rewind();
+private:
+    int m_source;
+    std::vector<ConsumedAction> m_actions;  // sorted by tick
+    size_t m_next;
+};
+
+#endif // INPUTPIPELINE_H_
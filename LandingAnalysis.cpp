@@ -0,0 +1,205 @@
+#include "LandingAnalysis.h"
+#include "Board.h"
+#include "GraphObject.h"
+using namespace std;
+
+static const int DIRS[4] = { GraphObject::right, GraphObject::up, GraphObject::left, GraphObject::down };
+
+static int dirIndex(int dir)
+{
+    return (dir / 90) & 3;
+}
+
+static int reverseDir(int dir)
+{
+    return (dir + 180) % 360;
+}
+
+static int neighbor(int cell, int dir)
+{
+    int x = LandingAnalysis::xOf(cell);
+    int y = LandingAnalysis::yOf(cell);
+    switch (dir)
+    {
+        case GraphObject::right: x++; break;
+        case GraphObject::left:  x--; break;
+        case GraphObject::up:    y++; break;
+        case GraphObject::down:  y--; break;
+    }
+    if (x < 0 || x >= BOARD_WIDTH || y < 0 || y >= BOARD_HEIGHT)
+        return -1;
+    return LandingAnalysis::cellOf(x, y);
+}
+
+LandingAnalysis::LandingAnalysis()
+{
+    for (int cell = 0; cell < NUM_CELLS; cell++)
+    {
+        m_isSquare[cell] = false;
+        m_forcedDir[cell] = -1;
+    }
+}
+
+void LandingAnalysis::analyze(Board& board)
+{
+    m_squares.clear();
+    for (int cell = 0; cell < NUM_CELLS; cell++)
+    {
+        Board::GridEntry ge = board.getContentsOf(xOf(cell), yOf(cell));
+        m_isSquare[cell] = (ge != Board::empty);
+        switch (ge)
+        {
+            case Board::up_dir_square:    m_forcedDir[cell] = GraphObject::up; break;
+            case Board::down_dir_square:  m_forcedDir[cell] = GraphObject::down; break;
+            case Board::left_dir_square:  m_forcedDir[cell] = GraphObject::left; break;
+            case Board::right_dir_square: m_forcedDir[cell] = GraphObject::right; break;
+            default:                      m_forcedDir[cell] = -1; break;
+        }
+        if (m_isSquare[cell])
+            m_squares.push_back(cell);
+    }
+    
+    vector<int> passed;
+    for (int policy = 0; policy < NUM_FORK_POLICIES; policy++)
+    {
+        for (int cell = 0; cell < NUM_CELLS; cell++)
+        {
+            for (int d = 0; d < 4; d++)
+            {
+                vector<LandingPath>& out = m_paths[policy][cell][d];
+                out.clear();
+                if (!m_isSquare[cell])
+                    continue;
+                for (int roll = 1; roll <= 10; roll++)
+                    walk(cell, DIRS[d], roll, roll, 0.1, passed, static_cast<ForkPolicy>(policy), out);
+            }
+        }
+    }
+}
+
+bool LandingAnalysis::isSquare(int cell) const
+{
+    return cell >= 0 && cell < NUM_CELLS && m_isSquare[cell];
+}
+
+const vector<int>& LandingAnalysis::squares() const
+{
+    return m_squares;
+}
+
+const vector<LandingPath>& LandingAnalysis::paths(int cell, int dir, ForkPolicy policy) const
+{
+    return m_paths[policy][cell][dirIndex(dir)];
+}
+
+vector<double> LandingAnalysis::landingDistribution(int cell, int dir, ForkPolicy policy) const
+{
+    vector<double> dist(NUM_CELLS, 0.0);
+    for (const LandingPath& path : paths(cell, dir, policy))
+        dist[path.landingCell] += path.probability;
+    return dist;
+}
+
+vector<double> LandingAnalysis::passDistribution(int cell, int dir, ForkPolicy policy) const
+{
+    vector<double> dist(NUM_CELLS, 0.0);
+    for (const LandingPath& path : paths(cell, dir, policy))
+    {
+        // A path round a short loop crosses a cell twice, and a bank takes
+        // a deposit on each visit, so both count
+        for (int c : path.passed)
+            dist[c] += path.probability;
+    }
+    return dist;
+}
+
+int LandingAnalysis::cellOf(int x, int y)
+{
+    return y * BOARD_WIDTH + x;
+}
+
+int LandingAnalysis::xOf(int cell)
+{
+    return cell % BOARD_WIDTH;
+}
+
+int LandingAnalysis::yOf(int cell)
+{
+    return cell / BOARD_WIDTH;
+}
+
+// Same rule as Mover::canGoInDir for a mover standing on a square
+bool LandingAnalysis::canGoInDir(int cell, int dir) const
+{
+    int next = neighbor(cell, dir);
+    return next >= 0 && m_isSquare[next];
+}
+
+int LandingAnalysis::countValidDirs(int cell) const
+{
+    int count = 0;
+    for (int d = 0; d < 4; d++)
+    {
+        if (canGoInDir(cell, DIRS[d]))
+            count++;
+    }
+    return count;
+}
+
+// Same rule as Mover::setAutomaticWalkDir
+int LandingAnalysis::automaticDir(int cell, int dir) const
+{
+    if (dir == GraphObject::right || dir == GraphObject::left)
+        return canGoInDir(cell, GraphObject::up) ? GraphObject::up : GraphObject::down;
+    return canGoInDir(cell, GraphObject::right) ? GraphObject::right : GraphObject::left;
+}
+
+// Follows Player::doSomething one square at a time: a direction square sets
+// the way on, otherwise the player picks at a fork and turns at a corner
+void LandingAnalysis::walk(int cell, int dir, int roll, int squaresLeft, double probability,
+                           vector<int>& passed, ForkPolicy policy, vector<LandingPath>& out) const
+{
+    if (m_forcedDir[cell] >= 0)
+        dir = m_forcedDir[cell];
+    else
+    {
+        if (countValidDirs(cell) > 2)
+        {
+            int exits[4];
+            int numExits = 0;
+            for (int d = 0; d < 4; d++)
+            {
+                if (DIRS[d] != reverseDir(dir) && canGoInDir(cell, DIRS[d]))
+                    exits[numExits++] = DIRS[d];
+            }
+            bool straight = (policy == fork_straight && canGoInDir(cell, dir));
+            if (!straight && numExits > 0)
+            {
+                for (int i = 0; i < numExits; i++)
+                    step(cell, exits[i], roll, squaresLeft, probability / numExits, passed, policy, out);
+                return;
+            }
+        }
+        if (!canGoInDir(cell, dir))
+            dir = automaticDir(cell, dir);
+    }
+    step(cell, dir, roll, squaresLeft, probability, passed, policy, out);
+}
+
+// Moves one square on from cell, then lands or keeps walking
+void LandingAnalysis::step(int cell, int dir, int roll, int squaresLeft, double probability,
+                           vector<int>& passed, ForkPolicy policy, vector<LandingPath>& out) const
+{
+    int next = neighbor(cell, dir);
+    if (next < 0 || !m_isSquare[next])
+        return;  // only on a malformed board, where the game walks off the path
+    if (squaresLeft == 1)
+    {
+        int landingDir = (m_forcedDir[next] >= 0) ? m_forcedDir[next] : dir;
+        out.push_back(LandingPath{ roll, probability, next, landingDir, passed });
+        return;
+    }
+    passed.push_back(next);
+    walk(next, dir, roll, squaresLeft - 1, probability, passed, policy, out);
+    passed.pop_back();
+}
@@ -0,0 +1,72 @@
+#ifndef LANDINGANALYSIS_H_
+#define LANDINGANALYSIS_H_
+
+#include "GameConstants.h"
+#include <vector>
+
+class Board;
+
+// How a player picks an exit at a fork
+enum ForkPolicy {
+    fork_uniform,     // any exit but back the way they came, equally likely (what RandomBot does)
+    fork_straight,    // keep going straight when possible, otherwise uniform
+    NUM_FORK_POLICIES
+};
+
+// One way a roll can play out, from a player at rest to where they land
+struct LandingPath
+{
+    int roll;                  // 1 to 10
+    double probability;        // of this roll and these fork choices together
+    int landingCell;
+    int landingDir;            // walk direction after landing
+    std::vector<int> passed;   // cells walked over before landing, in order
+};
+
+// Movement is deterministic apart from the die and the choices at forks, so
+// where a roll can end up is computed exactly from the board rather than by
+// playing games.  Cells are numbered y * BOARD_WIDTH + x; directions are the
+// GraphObject angles.  Square effects other than direction squares (events,
+// Bowser's droppings) are not modeled.
+class LandingAnalysis
+{
+public:
+    LandingAnalysis();
+    
+    // Builds the tables for every square, direction and fork policy
+    void analyze(Board& board);
+    
+    bool isSquare(int cell) const;
+    const std::vector<int>& squares() const;
+    
+    // Every way a roll can go for a player resting on cell, walking in dir
+    const std::vector<LandingPath>& paths(int cell, int dir, ForkPolicy policy) const;
+    
+    // Chance of landing on each cell, indexed by cell
+    std::vector<double> landingDistribution(int cell, int dir, ForkPolicy policy) const;
+    
+    // Expected number of times each cell is walked over without landing
+    // there (e.g. making a bank deposit), indexed by cell
+    std::vector<double> passDistribution(int cell, int dir, ForkPolicy policy) const;
+    
+    static int cellOf(int x, int y);
+    static int xOf(int cell);
+    static int yOf(int cell);
+private:
+    static const int NUM_CELLS = BOARD_WIDTH * BOARD_HEIGHT;
+    
+    bool m_isSquare[NUM_CELLS];
+    int m_forcedDir[NUM_CELLS];    // direction squares: the direction they set, else -1
+    std::vector<int> m_squares;
+    std::vector<LandingPath> m_paths[NUM_FORK_POLICIES][NUM_CELLS][4];
+    
+    bool canGoInDir(int cell, int dir) const;
+    int countValidDirs(int cell) const;
+    int automaticDir(int cell, int dir) const;
+    void walk(int cell, int dir, int roll, int squaresLeft, double probability,
+              std::vector<int>& passed, ForkPolicy policy, std::vector<LandingPath>& out) const;
+    void step(int cell, int dir, int roll, int squaresLeft, double probability,
+              std::vector<int>& passed, ForkPolicy policy, std::vector<LandingPath>& out) const;
+};
+
+#endif // LANDINGANALYSIS_H_
@@ -0,0 +1,85 @@
+#include "MappedFile.h"
+#include <fstream>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+MappedFile::MappedFile()
+ : m_data(nullptr), m_size(0), m_mapped(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const string& path)
+{
+    close();
+#if defined(_WIN32)
+    return readAll(path);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+    m_size = static_cast<size_t>(info.st_size);
+    if (m_size > 0)
+    {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            m_data = static_cast<const unsigned char*>(data);
+            m_mapped = true;
+        }
+    }
+    ::close(fd);
+    // Some file systems can't map; read it instead
+    if (m_size > 0 && !m_mapped)
+        return readAll(path);
+    return true;
+#endif
+}
+
+void MappedFile::close()
+{
+#if !defined(_WIN32)
+    if (m_mapped)
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_copy.clear();
+}
+
+const unsigned char* MappedFile::data() const
+{
+    return m_data;
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+bool MappedFile::readAll(const string& path)
+{
+    ifstream file(path, ios::in|ios::binary);
+    if (!file)
+        return false;
+    m_copy.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    m_data = m_copy.data();
+    m_size = m_copy.size();
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// A read-only view of a whole file.  It is memory-mapped where the platform
+// allows, so decoders can work straight from the page cache; otherwise (or
+// if mapping fails) the file is read into memory.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // False if the file can't be opened or isn't a regular file
+    bool open(const std::string& path);
+    void close();
+
+    const unsigned char* data() const;
+    size_t size() const;
+private:
+    const unsigned char* m_data;
+    size_t m_size;
+    bool m_mapped;
+    std::vector<unsigned char> m_copy;
+
+    bool readAll(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+#endif // MAPPEDFILE_H_
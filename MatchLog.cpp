@@ -0,0 +1,365 @@
+#include "MatchLog.h"
+#include "Bot.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+namespace
+{
+    const char MAGIC[8] = { 'P', 'E', 'A', 'C', 'H', 'M', 'L', 'G' };
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = 12;
+    const size_t BLOCK_HEADER_SIZE = 8;
+
+    size_t padded(size_t bytes)
+    {
+        return (bytes + 3) & ~static_cast<size_t>(3);
+    }
+
+    template<typename T>
+    void writeColumn(ofstream& out, const vector<T>& column)
+    {
+        static const char padding[4] = {};
+        size_t bytes = column.size() * sizeof(T);
+        out.write(reinterpret_cast<const char*>(column.data()), bytes);
+        out.write(padding, padded(bytes) - bytes);
+    }
+
+    template<typename T>
+    bool takeColumn(const unsigned char* data, size_t size, size_t& pos, size_t count, const T*& column)
+    {
+        size_t bytes = count * sizeof(T);
+        if (bytes / sizeof(T) != count || size - pos < padded(bytes))
+            return false;
+        column = reinterpret_cast<const T*>(data + pos);
+        pos += padded(bytes);
+        return true;
+    }
+
+    const char* botName(int bot)
+    {
+        return (bot < NUM_BOTS) ? BOT_NAMES[bot] : "unknown";
+    }
+}
+
+// WRITING
+
+MatchWriter::MatchWriter()
+ : m_recordsPerBlock(4096), m_open(false), m_closing(false), m_failed(false), m_recordsAdded(0)
+{
+}
+
+MatchWriter::~MatchWriter()
+{
+    close();
+}
+
+bool MatchWriter::open(const string& path, int recordsPerBlock)
+{
+    close();
+    m_file.open(path, ios::out|ios::binary|ios::trunc);
+    if (!m_file)
+        return false;
+    m_file.write(MAGIC, sizeof(MAGIC));
+    m_file.write(reinterpret_cast<const char*>(&VERSION), 4);
+    m_recordsPerBlock = max(1, recordsPerBlock);
+    m_open = true;
+    m_closing = false;
+    m_failed = false;
+    m_recordsAdded = 0;
+    m_filling.reset(new Block);
+    m_thread = thread(&MatchWriter::writerLoop, this);
+    return true;
+}
+
+void MatchWriter::add(const MatchRecord& record)
+{
+    lock_guard<mutex> lock(m_mutex);
+    if (!m_open)
+        return;
+    Block& b = *m_filling;
+    b.game.push_back(record.game);
+    b.board.push_back(record.board);
+    b.seed.push_back(record.seed);
+    b.players.push_back(static_cast<uint8_t>(record.numPlayers));
+    b.winner.push_back(static_cast<uint8_t>(record.winner));
+    b.bank.push_back(record.bank);
+    b.ticks.push_back(static_cast<uint32_t>(record.ticks));
+    for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+        b.events[e].push_back(record.events[e]);
+    for (int p = 0; p < record.numPlayers; p++)
+    {
+        b.bots.push_back(static_cast<uint8_t>(record.bots[p]));
+        b.stars.push_back(record.stars[p]);
+        b.coins.push_back(record.coins[p]);
+    }
+    m_recordsAdded++;
+    if (static_cast<int>(b.game.size()) >= m_recordsPerBlock)
+    {
+        m_queue.push_back(std::move(m_filling));
+        m_filling.reset(new Block);
+        m_cv.notify_one();
+    }
+}
+
+bool MatchWriter::close()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (!m_open)
+            return !m_failed;
+        if (!m_filling->game.empty())
+            m_queue.push_back(std::move(m_filling));
+        m_closing = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    m_file.close();
+    m_open = false;
+    m_filling.reset();
+    return !m_failed;
+}
+
+long long MatchWriter::recordsAdded() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_recordsAdded;
+}
+
+void MatchWriter::writerLoop()
+{
+    unique_lock<mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_cv.wait(lock, [this] { return !m_queue.empty() || m_closing; });
+        if (m_queue.empty())
+            break;
+        unique_ptr<Block> block = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+        bool written = writeBlock(*block);
+        lock.lock();
+        if (!written)
+            m_failed = true;
+    }
+    if (!m_file.flush())
+        m_failed = true;
+}
+
+bool MatchWriter::writeBlock(const Block& block)
+{
+    uint32_t counts[2] = { static_cast<uint32_t>(block.game.size()), static_cast<uint32_t>(block.bots.size()) };
+    m_file.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+    writeColumn(m_file, block.game);
+    writeColumn(m_file, block.board);
+    writeColumn(m_file, block.seed);
+    writeColumn(m_file, block.players);
+    writeColumn(m_file, block.winner);
+    writeColumn(m_file, block.bank);
+    writeColumn(m_file, block.ticks);
+    for (const auto& column : block.events)
+        writeColumn(m_file, column);
+    writeColumn(m_file, block.bots);
+    writeColumn(m_file, block.stars);
+    writeColumn(m_file, block.coins);
+    return static_cast<bool>(m_file);
+}
+
+// READING
+
+bool MatchReader::open(const string& path)
+{
+    m_path = path;
+    m_pos = HEADER_SIZE;
+    m_failed = false;
+    if (!m_file.open(path))
+    {
+        cerr << "Cannot open " << path << endl;
+        return false;
+    }
+    uint32_t version = 0;
+    if (m_file.size() >= HEADER_SIZE && memcmp(m_file.data(), MAGIC, sizeof(MAGIC)) == 0)
+        memcpy(&version, m_file.data() + 8, 4);
+    if (version != VERSION)
+    {
+        cerr << path << " is not a match log this build can read" << endl;
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool MatchReader::nextBlock(MatchColumns& columns)
+{
+    const unsigned char* data = m_file.data();
+    size_t size = m_file.size();
+    if (m_failed || data == nullptr || m_pos >= size)
+        return false;
+
+    uint32_t counts[2];
+    size_t pos = m_pos + BLOCK_HEADER_SIZE;
+    bool ok = (size - m_pos >= BLOCK_HEADER_SIZE);
+    if (ok)
+    {
+        memcpy(counts, data + m_pos, sizeof(counts));
+        columns.numRecords = counts[0];
+        columns.numPlayerSlots = counts[1];
+        size_t n = columns.numRecords;
+        ok = takeColumn(data, size, pos, n, columns.game) && takeColumn(data, size, pos, n, columns.board) &&
+             takeColumn(data, size, pos, n, columns.seed) && takeColumn(data, size, pos, n, columns.players) &&
+             takeColumn(data, size, pos, n, columns.winner) && takeColumn(data, size, pos, n, columns.bank) &&
+             takeColumn(data, size, pos, n, columns.ticks);
+        for (int e = 0; e < NUM_HEAT_EVENTS && ok; e++)
+            ok = takeColumn(data, size, pos, n, columns.events[e]);
+        size_t slots = columns.numPlayerSlots;
+        ok = ok && takeColumn(data, size, pos, slots, columns.bots) && takeColumn(data, size, pos, slots, columns.stars) &&
+             takeColumn(data, size, pos, slots, columns.coins);
+    }
+    // The players column must account for every player slot
+    size_t players = 0;
+    for (size_t r = 0; ok && r < columns.numRecords; r++)
+        players += columns.players[r];
+    if (!ok || players != columns.numPlayerSlots)
+    {
+        cerr << "Damaged match log block at byte " << m_pos << " of " << m_path << endl;
+        m_failed = true;
+        return false;
+    }
+    m_pos = pos;
+    return true;
+}
+
+bool MatchReader::failed() const
+{
+    return m_failed;
+}
+
+// SUMMARIES
+
+void MatchSummary::add(const MatchColumns& columns)
+{
+    size_t n = columns.numRecords;
+    games += n;
+    for (size_t r = 0; r < n; r++)
+    {
+        ticks += columns.ticks[r];
+        bank += columns.bank[r];
+    }
+    for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+    {
+        const uint32_t* column = columns.events[e];
+        long long total = 0;
+        for (size_t r = 0; r < n; r++)
+            total += column[r];
+        events[e] += total;
+    }
+
+    // Walk the player slots alongside the records they belong to
+    size_t slot = 0;
+    for (size_t r = 0; r < n; r++)
+    {
+        int numPlayers = columns.players[r];
+        int winner = columns.winner[r];
+        maxPlayers = max(maxPlayers, numPlayers);
+        if (static_cast<int>(winsBySeat.size()) < numPlayers)
+            winsBySeat.resize(numPlayers);
+        if (winner >= 1 && winner <= numPlayers)
+            winsBySeat[winner - 1]++;
+        for (int p = 1; p <= numPlayers; p++, slot++)
+        {
+            int bot = columns.bots[slot];
+            if (bot >= static_cast<int>(seats.size()))
+            {
+                seats.resize(bot + 1);
+                wins.resize(bot + 1);
+                stars.resize(bot + 1);
+                coins.resize(bot + 1);
+            }
+            seats[bot]++;
+            wins[bot] += (p == winner);
+            stars[bot] += columns.stars[slot];
+            coins[bot] += columns.coins[slot];
+        }
+    }
+}
+
+void MatchSummary::merge(const MatchSummary& other)
+{
+    games += other.games;
+    maxPlayers = max(maxPlayers, other.maxPlayers);
+    ticks += other.ticks;
+    bank += other.bank;
+    for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+        events[e] += other.events[e];
+    if (winsBySeat.size() < other.winsBySeat.size())
+        winsBySeat.resize(other.winsBySeat.size());
+    for (size_t i = 0; i < other.winsBySeat.size(); i++)
+        winsBySeat[i] += other.winsBySeat[i];
+    if (seats.size() < other.seats.size())
+    {
+        seats.resize(other.seats.size());
+        wins.resize(other.seats.size());
+        stars.resize(other.seats.size());
+        coins.resize(other.seats.size());
+    }
+    for (size_t b = 0; b < other.seats.size(); b++)
+    {
+        seats[b] += other.seats[b];
+        wins[b] += other.wins[b];
+        stars[b] += other.stars[b];
+        coins[b] += other.coins[b];
+    }
+}
+
+void MatchSummary::print(ostream& out) const
+{
+    double perGame = (games > 0) ? 1.0 / games : 0;
+    out << fixed << setprecision(2);
+    out << games << " games, " << ticks * perGame << " ticks and " << bank * perGame << " coins left in the bank a game\n";
+    out << "wins by seat:";
+    for (size_t i = 0; i < winsBySeat.size(); i++)
+        out << " " << (i + 1) << ":" << winsBySeat[i];
+    out << "\n";
+    for (size_t b = 0; b < seats.size(); b++)
+    {
+        if (seats[b] == 0)
+            continue;
+        double perSeat = 1.0 / seats[b];
+        out << botName(static_cast<int>(b)) << ": " << seats[b] << " seats, " << wins[b] << " wins ("
+            << 100.0 * wins[b] * perSeat << "%), " << stars[b] * perSeat << " stars and "
+            << coins[b] * perSeat << " coins a seat\n";
+    }
+    out << "events a game:";
+    for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+        out << " " << heatEventName(static_cast<HeatEvent>(e)) << " " << events[e] * perGame;
+    out << endl;
+    out.unsetf(ios::floatfield);
+}
+
+void writeMatchCsvHeading(ostream& out, int numSeats)
+{
+    out << "game,board,seed,players,winner,bank,ticks";
+    for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+        out << "," << heatEventName(static_cast<HeatEvent>(e));
+    for (int p = 1; p <= numSeats; p++)
+        out << ",bot" << p << ",stars" << p << ",coins" << p;
+    out << "\n";
+}
+
+void writeMatchCsv(const MatchColumns& columns, ostream& out)
+{
+    size_t slot = 0;
+    for (size_t r = 0; r < columns.numRecords; r++)
+    {
+        out << columns.game[r] << "," << columns.board[r] << "," << columns.seed[r] << ","
+            << int(columns.players[r]) << "," << int(columns.winner[r]) << "," << columns.bank[r] << ","
+            << columns.ticks[r];
+        for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+            out << "," << columns.events[e][r];
+        for (int p = 0; p < columns.players[r]; p++, slot++)
+            out << "," << botName(columns.bots[slot]) << "," << columns.stars[slot] << "," << columns.coins[slot];
+        out << "\n";
+    }
+}
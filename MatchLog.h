@@ -0,0 +1,153 @@
+#ifndef MATCHLOG_H_
+#define MATCHLOG_H_
+
+#include "GameConstants.h"
+#include "Heatmap.h"
+#include "MappedFile.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <ostream>
+#include <cstdint>
+
+// How one finished match came out
+struct MatchRecord
+{
+    int game;                  // number within its run
+    int board;                 // board number, or 0 for a generated board
+    unsigned int seed;         // the game's own seed
+    int winner;                // player number
+    int bank;
+    long long ticks;
+    int numPlayers;
+    int bots[MAX_PLAYERS];     // index into BOT_NAMES, for each player
+    int stars[MAX_PLAYERS];
+    int coins[MAX_PLAYERS];
+    unsigned int events[NUM_HEAT_EVENTS];
+};
+
+// A match log holds records in blocks, each stored a column at a time so a
+// reader can add up one field over thousands of games in a tight loop.
+//
+// Layout (little-endian):
+//   header   "PEACHMLG", version
+//   blocks   record and player-slot counts, then every column: one entry
+//            per record for the match fields, one per player slot (records'
+//            players one after another) for bots, stars and coins.  Columns
+//            are padded to 4 bytes.
+
+// A block's columns
+struct MatchColumns
+{
+    size_t numRecords = 0;
+    size_t numPlayerSlots = 0;     // total players over the block's records
+
+    // One per record
+    const int32_t* game = nullptr;
+    const int32_t* board = nullptr;
+    const uint32_t* seed = nullptr;
+    const uint8_t* players = nullptr;
+    const uint8_t* winner = nullptr;
+    const int32_t* bank = nullptr;
+    const uint32_t* ticks = nullptr;
+    const uint32_t* events[NUM_HEAT_EVENTS] = {};
+
+    // One per player slot
+    const uint8_t* bots = nullptr;
+    const int32_t* stars = nullptr;
+    const int32_t* coins = nullptr;
+};
+
+// Appends records to a match log from any number of threads.  add() only
+// copies the record into the block being filled; full blocks are written
+// by a background thread, so callers never wait on the disk.
+class MatchWriter
+{
+public:
+    MatchWriter();
+    ~MatchWriter();
+
+    bool open(const std::string& path, int recordsPerBlock = 4096);
+    void add(const MatchRecord& record);
+    // Writes what's left; false if anything couldn't be written
+    bool close();
+
+    long long recordsAdded() const;
+private:
+    // A block being filled, with storage for every column
+    struct Block
+    {
+        std::vector<int32_t> game, board, bank;
+        std::vector<uint32_t> seed, ticks;
+        std::vector<uint8_t> players, winner;
+        std::vector<uint32_t> events[NUM_HEAT_EVENTS];
+        std::vector<uint8_t> bots;
+        std::vector<int32_t> stars, coins;
+    };
+
+    std::ofstream m_file;
+    int m_recordsPerBlock;
+    bool m_open;
+    bool m_closing;
+    bool m_failed;
+    long long m_recordsAdded;
+    std::unique_ptr<Block> m_filling;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::unique_ptr<Block>> m_queue;
+
+    void writerLoop();
+    bool writeBlock(const Block& block);
+};
+
+// Reads a match log a block at a time, straight from a mapped file
+class MatchReader
+{
+public:
+    // False, with a message on cerr, if path isn't a match log
+    bool open(const std::string& path);
+    // Fills columns with the next block; false at the end or if the rest
+    // of the file is damaged (see failed())
+    bool nextBlock(MatchColumns& columns);
+    bool failed() const;
+private:
+    MappedFile m_file;
+    std::string m_path;
+    size_t m_pos = 0;
+    bool m_failed = false;
+};
+
+// Totals over any number of match logs
+struct MatchSummary
+{
+    long long games = 0;
+    int maxPlayers = 0;
+    long long ticks = 0;
+    long long bank = 0;
+    long long events[NUM_HEAT_EVENTS] = {};
+    std::vector<long long> winsBySeat;     // indexed by player number - 1
+
+    // Per bot, indexed like BOT_NAMES
+    std::vector<long long> seats;
+    std::vector<long long> wins;
+    std::vector<long long> stars;
+    std::vector<long long> coins;
+
+    void add(const MatchColumns& columns);
+    void merge(const MatchSummary& other);
+    void print(std::ostream& out) const;
+};
+
+// CSV with one line per record: the match fields, then bot, stars and coins
+// for each player.  The heading names numSeats players' columns.
+void writeMatchCsvHeading(std::ostream& out, int numSeats);
+void writeMatchCsv(const MatchColumns& columns, std::ostream& out);
+
+#endif // MATCHLOG_H_
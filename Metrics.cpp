@@ -0,0 +1,326 @@
+#include "Metrics.h"
+#include "PerfStats.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace
+{
+    const char* const METRIC_NAMES[NUM_METRICS] = {
+        "peach_ticks_total", "peach_moves_total", "peach_timed_moves_total", "peach_move_ns_total",
+        "peach_matches_completed_total", "peach_actors_alive{type=\"player\"}",
+        "peach_actors_alive{type=\"bowser\"}", "peach_actors_alive{type=\"boo\"}",
+        "peach_actors_alive{type=\"vortex\"}", "peach_vortex_shots_total", "peach_vortex_hits_total",
+        "peach_actor_allocations_total", "peach_vortex_reuses_total", "peach_frames_total",
+        "peach_frames_dropped_total"
+    };
+
+    // How often the exporter thread looks at the rate when nothing happens
+    const int POLL_MS = 250;
+
+    // The exporter that answers signals; the handler can only write a byte
+    // to its wake pipe
+    volatile sig_atomic_t signalWakeFd = -1;
+    volatile sig_atomic_t dumpRequested = 0;
+
+    void onDumpSignal(int)
+    {
+        dumpRequested = 1;
+#if !defined(_WIN32)
+        int fd = signalWakeFd;
+        if (fd >= 0)
+        {
+            char byte = 'd';
+            ssize_t written = write(fd, &byte, 1);
+            (void)written;
+        }
+#endif
+    }
+}
+
+Metrics::Shard Metrics::s_shards[MAX_SHARDS];
+Metrics::Shard Metrics::s_overflow;
+
+// Hands a thread's shard back when the thread ends; its counts stay in the
+// totals and the next thread to claim it carries on from them
+struct ShardRelease
+{
+    Metrics::Shard* shard = nullptr;
+    ~ShardRelease()
+    {
+        if (shard != nullptr)
+        {
+            Metrics::t_shard = nullptr;
+            shard->claimed.store(false, memory_order_release);
+        }
+    }
+};
+
+Metrics::Shard* Metrics::claimShard()
+{
+    static thread_local ShardRelease release;
+    for (Shard& shard : s_shards)
+    {
+        bool expected = false;
+        if (!shard.claimed.load(memory_order_relaxed) &&
+            shard.claimed.compare_exchange_strong(expected, true, memory_order_acquire))
+        {
+            release.shard = &shard;
+            t_shard = &shard;
+            return t_shard;
+        }
+    }
+    t_shard = &s_overflow;
+    return t_shard;
+}
+
+long long Metrics::value(MetricId id)
+{
+    long long sum = s_overflow.values[id].load(memory_order_relaxed);
+    for (const Shard& shard : s_shards)
+        sum += shard.values[id].load(memory_order_relaxed);
+    return sum;
+}
+
+const char* Metrics::name(MetricId id)
+{
+    return METRIC_NAMES[id];
+}
+
+void Metrics::setEnabled(bool on)
+{
+    s_enabled.store(on, memory_order_relaxed);
+}
+
+MetricsExporter::MetricsExporter()
+ : m_listenFd(-1), m_running(false), m_rateTicks(Metrics::value(metric_ticks)), m_rateStartMs(PerfStats::nowMs()),
+   m_ticksPerSecond(0), m_haveRate(false)
+{
+    m_wakeFds[0] = m_wakeFds[1] = -1;
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stop();
+}
+
+#if defined(_WIN32)
+
+bool MetricsExporter::serve(const string&)
+{
+    cerr << "Metrics sockets aren't supported on this platform" << endl;
+    return false;
+}
+
+bool MetricsExporter::dumpOnSignal(const string&, int)
+{
+    cerr << "Metrics dumps on a signal aren't supported on this platform" << endl;
+    return false;
+}
+
+bool MetricsExporter::start()
+{
+    return false;
+}
+
+void MetricsExporter::run()
+{
+}
+
+void MetricsExporter::stop()
+{
+}
+
+#else
+
+bool MetricsExporter::serve(const string& socketPath)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (m_running || socketPath.empty() || socketPath.size() >= sizeof(address.sun_path))
+    {
+        cerr << "Cannot serve metrics on " << socketPath << endl;
+        return false;
+    }
+    strcpy(address.sun_path, socketPath.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        cerr << "Cannot create a socket for metrics" << endl;
+        return false;
+    }
+    unlink(socketPath.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 8) != 0)
+    {
+        cerr << "Cannot serve metrics on " << socketPath << ": " << strerror(errno) << endl;
+        close(fd);
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    m_listenFd = fd;
+    m_socketPath = socketPath;
+    return start();
+}
+
+bool MetricsExporter::dumpOnSignal(const string& path, int signal)
+{
+    if (signalWakeFd >= 0)
+    {
+        cerr << "Metrics are already dumped on a signal" << endl;
+        return false;
+    }
+    m_dumpPath = path;
+    if (!start())
+        return false;
+    signalWakeFd = m_wakeFds[1];
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onDumpSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction((signal != 0) ? signal : SIGUSR1, &action, nullptr);
+    return true;
+}
+
+// Both ways of exporting share one thread, started by whichever is set up
+// first
+bool MetricsExporter::start()
+{
+    if (m_running)
+        return true;
+    if (pipe(m_wakeFds) != 0)
+    {
+        cerr << "Cannot start the metrics exporter" << endl;
+        return false;
+    }
+    fcntl(m_wakeFds[1], F_SETFL, fcntl(m_wakeFds[1], F_GETFL) | O_NONBLOCK);
+    m_running = true;
+    Metrics::setEnabled(true);
+    m_thread = thread(&MetricsExporter::run, this);
+    return true;
+}
+
+void MetricsExporter::run()
+{
+    pollfd fds[2];
+    fds[0].fd = m_wakeFds[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = m_listenFd;
+    fds[1].events = POLLIN;
+    for (;;)
+    {
+        int ready = poll(fds, (m_listenFd >= 0) ? 2 : 1, POLL_MS);
+        updateRate();
+        if (ready <= 0)
+            continue;
+        if (fds[0].revents & POLLIN)
+        {
+            char bytes[64];
+            ssize_t numRead = read(m_wakeFds[0], bytes, sizeof(bytes));
+            if (numRead <= 0 || memchr(bytes, 'q', numRead) != nullptr)
+                return;
+        }
+        if (dumpRequested)
+        {
+            dumpRequested = 0;
+            if (!m_dumpPath.empty() && !dump(m_dumpPath))
+                cerr << "Cannot write metrics to " << m_dumpPath << endl;
+        }
+        if (m_listenFd >= 0 && (fds[1].revents & POLLIN))
+        {
+            // Each client gets one snapshot; a client that won't take it
+            // all at once gets what fits
+            int client;
+            while ((client = accept(m_listenFd, nullptr, nullptr)) >= 0)
+            {
+                string snapshot = text();
+                ssize_t sent = send(client, snapshot.data(), snapshot.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+                (void)sent;
+                close(client);
+            }
+        }
+    }
+}
+
+void MetricsExporter::stop()
+{
+    if (!m_running)
+        return;
+    if (signalWakeFd == m_wakeFds[1])
+        signalWakeFd = -1;
+    char quit = 'q';
+    ssize_t written = write(m_wakeFds[1], &quit, 1);
+    (void)written;
+    m_thread.join();
+    m_running = false;
+    Metrics::setEnabled(false);
+    close(m_wakeFds[0]);
+    close(m_wakeFds[1]);
+    m_wakeFds[0] = m_wakeFds[1] = -1;
+    if (m_listenFd >= 0)
+    {
+        close(m_listenFd);
+        unlink(m_socketPath.c_str());
+        m_listenFd = -1;
+    }
+}
+
+#endif
+
+bool MetricsExporter::dump(const string& path)
+{
+    ofstream out(path);
+    out << text();
+    return static_cast<bool>(out);
+}
+
+// The tick rate is taken over at least a second, so it doesn't depend on
+// how often anyone asks; until the first second is up it is the rate so far
+void MetricsExporter::updateRate()
+{
+    lock_guard<mutex> lock(m_rateMutex);
+    double now = PerfStats::nowMs();
+    double elapsed = now - m_rateStartMs;
+    if (elapsed <= 0 || (elapsed < 1000 && m_haveRate))
+        return;
+    long long ticks = Metrics::value(metric_ticks);
+    m_ticksPerSecond = (ticks - m_rateTicks) * 1000 / elapsed;
+    if (elapsed < 1000)
+        return;
+    m_rateTicks = ticks;
+    m_rateStartMs = now;
+    m_haveRate = true;
+}
+
+string MetricsExporter::text()
+{
+    updateRate();
+    ostringstream out;
+    for (int m = 0; m < NUM_METRICS; m++)
+        out << Metrics::name(static_cast<MetricId>(m)) << " " << Metrics::value(static_cast<MetricId>(m)) << "\n";
+
+    double ticksPerSecond;
+    {
+        lock_guard<mutex> lock(m_rateMutex);
+        ticksPerSecond = m_ticksPerSecond;
+    }
+    long long timedMoves = Metrics::value(metric_timed_moves);
+    double moveUs = (timedMoves == 0) ? 0 : Metrics::value(metric_move_ns) / 1000.0 / timedMoves;
+    out << fixed << setprecision(1) << "peach_ticks_per_second " << ticksPerSecond << "\n"
+        << setprecision(3) << "peach_move_avg_us " << moveUs << "\n";
+    return out.str();
+}
@@ -0,0 +1,115 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Process-wide counters for watching a running game or simulation.  Every
+// thread counts into a shard of its own, so counting is a plain store to a
+// cache line no other thread writes; readers add the shards up.  Nothing
+// takes a lock or allocates once a thread has its shard.
+enum MetricId {
+    metric_ticks,               // game ticks played, skipped ones included
+    metric_moves,               // calls to StudentWorld::move()
+    metric_timed_moves,         // moves sampled for timing while exporting
+    metric_move_ns,             // time spent in those moves
+    metric_matches,             // games finished by the batch runner
+    metric_players_alive,       // actors in play, by type
+    metric_bowsers_alive,
+    metric_boos_alive,
+    metric_vortices_alive,
+    metric_vortex_shots,
+    metric_vortex_hits,
+    metric_actor_allocations,   // actors constructed
+    metric_vortex_reuses,       // vortices fired from the pool instead
+    metric_frames,              // frames drawn by the game window
+    metric_frames_dropped,
+    NUM_METRICS
+};
+
+class Metrics
+{
+public:
+    static const int MAX_SHARDS = 256;
+
+    static void add(MetricId id, long long n = 1)
+    {
+        Shard* shard = t_shard;
+        if (shard == nullptr)
+            shard = claimShard();
+        std::atomic<long long>& value = shard->values[id];
+        if (shard == &s_overflow)
+            value.fetch_add(n, std::memory_order_relaxed);
+        else
+            value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // The sum over every thread that has counted, past and present
+    static long long value(MetricId id);
+    static const char* name(MetricId id);
+
+    // Whether anyone is watching; costly measurements (clock reads) are
+    // only taken while this is true
+    static bool enabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    static void setEnabled(bool on);
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<long long> values[NUM_METRICS];
+        std::atomic<bool> claimed;
+    };
+
+    static Shard s_shards[MAX_SHARDS];
+    static Shard s_overflow;          // shared by threads beyond MAX_SHARDS
+    inline static std::atomic<bool> s_enabled{false};
+    inline static thread_local Shard* t_shard = nullptr;
+
+    static Shard* claimShard();
+    friend struct ShardRelease;
+};
+
+// Publishes the metrics as text, one "name value" line each (plus ticks a
+// second and the average move() time), to every client that connects to a
+// Unix domain socket and/or to a file whenever the process gets a signal.
+// A background thread does the work, so the counting threads never wait.
+class MetricsExporter
+{
+public:
+    MetricsExporter();
+    ~MetricsExporter();
+
+    // Serves the text on a socket at path, replacing a stale one; false,
+    // with a message on cerr, if it can't.  Call before dumpOnSignal().
+    bool serve(const std::string& socketPath);
+    // Writes the text to path whenever signal arrives (SIGUSR1 if 0)
+    bool dumpOnSignal(const std::string& path, int signal = 0);
+    // Writes the text to path now
+    bool dump(const std::string& path);
+    std::string text();
+    void stop();
+private:
+    std::string m_socketPath;
+    std::string m_dumpPath;
+    int m_listenFd;
+    int m_wakeFds[2];
+    bool m_running;
+    std::thread m_thread;
+
+    // For the rate: ticks and time when it was last worked out
+    std::mutex m_rateMutex;
+    long long m_rateTicks;
+    double m_rateStartMs;
+    double m_ticksPerSecond;
+    bool m_haveRate;              // a whole second has been measured
+
+    bool start();
+    void run();
+    void updateRate();
+};
+
+#endif // METRICS_H_
@@ -0,0 +1,93 @@
+#include "MoverStore.h"
+#include "Actor.h"
+using namespace std;
+
+int MoverStore::add(Mover* owner, int startX, int startY)
+{
+    m_owners.push_back(owner);
+    x.push_back(startX);
+    y.push_back(startY);
+    dx.push_back(0);
+    dy.push_back(0);
+    int startDir = GraphObject::right;
+    walkDir.push_back(startDir);
+    ticks.push_back(0);
+    pause.push_back(0);
+    walking.push_back(0);
+    stepping.push_back(0);
+    return static_cast<int>(m_owners.size()) - 1;
+}
+
+void MoverStore::remove(int slot)
+{
+    int last = static_cast<int>(m_owners.size()) - 1;
+    if (slot != last)
+    {
+        m_owners[slot] = m_owners[last];
+        m_owners[slot]->m_slot = slot;
+        x[slot] = x[last];
+        y[slot] = y[last];
+        dx[slot] = dx[last];
+        dy[slot] = dy[last];
+        walkDir[slot] = walkDir[last];
+        ticks[slot] = ticks[last];
+        pause[slot] = pause[last];
+        walking[slot] = walking[last];
+        stepping[slot] = stepping[last];
+    }
+    m_owners.pop_back();
+    x.pop_back();
+    y.pop_back();
+    dx.pop_back();
+    dy.pop_back();
+    walkDir.pop_back();
+    ticks.pop_back();
+    pause.pop_back();
+    walking.pop_back();
+    stepping.pop_back();
+}
+
+int MoverStore::size() const
+{
+    return static_cast<int>(m_owners.size());
+}
+
+Mover* MoverStore::getOwner(int slot) const
+{
+    return m_owners[slot];
+}
+
+void MoverStore::stepAll()
+{
+    int n = size();
+    int* px = x.data();
+    int* py = y.data();
+    int* pt = ticks.data();
+    const int* pdx = dx.data();
+    const int* pdy = dy.data();
+    const unsigned char* ps = stepping.data();
+    
+    // No branches, so the compiler can vectorize this
+    for (int i = 0; i < n; i++)
+    {
+        int s = ps[i];
+        px[i] += pdx[i] * s;
+        py[i] += pdy[i] * s;
+        pt[i] -= s;
+    }
+    
+    m_stepped.clear();
+    for (int i = 0; i < n; i++)
+    {
+        if (stepping[i])
+        {
+            m_stepped.push_back(i);
+            stepping[i] = 0;
+        }
+    }
+}
+
+const vector<int>& MoverStore::getStepped() const
+{
+    return m_stepped;
+}
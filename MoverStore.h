@@ -0,0 +1,39 @@
+#ifndef MOVERSTORE_H_
+#define MOVERSTORE_H_
+
+#include <vector>
+
+class Mover;
+
+// The movement state of every mover in a world, kept in parallel arrays
+// indexed by slot rather than inside each Mover.  Movers decide what to do
+// one at a time, but the "advance 2 pixels and use up a tick" step they all
+// share is then applied to every stepping mover in one branch-free loop.
+class MoverStore
+{
+public:
+    int add(Mover* owner, int x, int y);
+    void remove(int slot);              // the last slot moves into the hole
+    int size() const;
+    Mover* getOwner(int slot) const;
+    
+    // Applies the requested steps and clears the requests
+    void stepAll();
+    // Slots that moved in the last stepAll()
+    const std::vector<int>& getStepped() const;
+    
+    std::vector<int> x;
+    std::vector<int> y;
+    std::vector<int> dx;                // pixels per step along the walk direction
+    std::vector<int> dy;
+    std::vector<int> walkDir;
+    std::vector<int> ticks;             // ticks of walking left
+    std::vector<int> pause;             // enemies: ticks left before moving again
+    std::vector<unsigned char> walking;
+    std::vector<unsigned char> stepping;
+private:
+    std::vector<Mover*> m_owners;
+    std::vector<int> m_stepped;
+};
+
+#endif // MOVERSTORE_H_
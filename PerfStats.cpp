@@ -0,0 +1,142 @@
+#include "PerfStats.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+using namespace std;
+
+static const char* const SERIES_NAMES[PerfStats::NUM_SERIES] = {
+	"frame_interval_ms", "tick_ms", "render_ms"
+};
+
+  // A frame counts as dropped once it arrives this much later than scheduled
+static const double DROPPED_FRAME_FACTOR = 1.5;
+
+PerfStats::PerfStats(int windowSize, double msPerFrame)
+ : m_msPerFrame(msPerFrame), m_rateStartMs(nowMs()), m_ticksSinceRate(0),
+   m_framesSinceRate(0), m_ticksPerSecond(0), m_framesPerSecond(0),
+   m_droppedFrames(0), m_totalFrames(0), m_totalTicks(0)
+{
+	for (auto& w : m_windows)
+	{
+		w.samples.assign(windowSize < 1 ? 1 : windowSize, 0);
+		w.next = 0;
+		w.count = 0;
+		w.sum = 0;
+	}
+}
+
+double PerfStats::nowMs()
+{
+	using namespace std::chrono;
+	return duration<double, milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+void PerfStats::record(Series series, double ms)
+{
+	Window& w = m_windows[series];
+	int size = static_cast<int>(w.samples.size());
+	if (w.count == size)
+		w.sum -= w.samples[w.next];
+	else
+		w.count++;
+	w.samples[w.next] = static_cast<float>(ms);
+	w.sum += ms;
+	w.next = (w.next + 1) % size;
+}
+
+void PerfStats::countTick(double nowMs)
+{
+	m_ticksSinceRate++;
+	m_totalTicks++;
+	updateRates(nowMs);
+}
+
+void PerfStats::recordFrameInterval(double intervalMs)
+{
+	record(frame_interval, intervalMs);
+	if (intervalMs > m_msPerFrame * DROPPED_FRAME_FACTOR)
+		m_droppedFrames++;
+}
+
+void PerfStats::countFrame(double nowMs)
+{
+	m_framesSinceRate++;
+	m_totalFrames++;
+	updateRates(nowMs);
+}
+
+void PerfStats::updateRates(double nowMs)
+{
+	double elapsed = nowMs - m_rateStartMs;
+	if (elapsed < 1000)
+		return;
+	m_ticksPerSecond = m_ticksSinceRate * 1000 / elapsed;
+	m_framesPerSecond = m_framesSinceRate * 1000 / elapsed;
+	m_ticksSinceRate = 0;
+	m_framesSinceRate = 0;
+	m_rateStartMs = nowMs;
+}
+
+double PerfStats::mean(Series series) const
+{
+	const Window& w = m_windows[series];
+	return (w.count == 0) ? 0 : w.sum / w.count;
+}
+
+double PerfStats::percentile(Series series, double p) const
+{
+	const Window& w = m_windows[series];
+	if (w.count == 0)
+		return 0;
+	vector<float> sorted(w.samples.begin(), w.samples.begin() + w.count);
+	size_t k = static_cast<size_t>(p / 100 * (sorted.size() - 1) + 0.5);
+	nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+	return sorted[k];
+}
+
+string PerfStats::summary() const
+{
+	  // Share of wall time spent simulating vs. rendering
+	double simShare = 100 * mean(tick_time) * m_ticksPerSecond / 1000;
+	double renderShare = 100 * mean(render_time) * m_framesPerSecond / 1000;
+
+	ostringstream oss;
+	oss << fixed << setprecision(0)
+	    << "TPS: " << m_ticksPerSecond << " FPS: " << m_framesPerSecond
+	    << setprecision(1)
+	    << " | Frame p50: " << percentile(frame_interval, 50) << "ms p99: " << percentile(frame_interval, 99) << "ms"
+	    << setprecision(0)
+	    << " | Sim: " << simShare << "% Render: " << renderShare << "%"
+	    << " | Dropped: " << m_droppedFrames;
+	return oss.str();
+}
+
+bool PerfStats::dump(string path) const
+{
+	ofstream out(path);
+	if (!out)
+		return false;
+	out << "# " << summary() << "\n";
+	out << "# frames " << m_totalFrames << " ticks " << m_totalTicks << " dropped " << m_droppedFrames << "\n";
+	out << "series,p50,p90,p99,max,mean\n";
+	for (int s = 0; s < NUM_SERIES; s++)
+	{
+		Series series = static_cast<Series>(s);
+		out << SERIES_NAMES[s] << "," << percentile(series, 50) << "," << percentile(series, 90) << ","
+		    << percentile(series, 99) << "," << percentile(series, 100) << "," << mean(series) << "\n";
+	}
+
+	  // Raw samples, oldest first
+	out << "series,sample_ms\n";
+	for (int s = 0; s < NUM_SERIES; s++)
+	{
+		const Window& w = m_windows[s];
+		int size = static_cast<int>(w.samples.size());
+		int first = (w.count == size) ? w.next : 0;
+		for (int i = 0; i < w.count; i++)
+			out << SERIES_NAMES[s] << "," << w.samples[(first + i) % size] << "\n";
+	}
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,61 @@
+#ifndef PERFSTATS_H_
+#define PERFSTATS_H_
+
+#include <string>
+#include <vector>
+
+// Rolling frame-pacing statistics.  Recording a sample is O(1) and never
+// allocates; percentiles are only computed when someone asks for them.
+
+class PerfStats
+{
+public:
+	enum Series {
+		frame_interval, tick_time, render_time, NUM_SERIES
+	};
+
+	PerfStats(int windowSize = 1024, double msPerFrame = 5);
+
+	  // Milliseconds on a monotonic clock
+	static double nowMs();
+
+	void record(Series series, double ms);
+	void recordFrameInterval(double intervalMs);
+	void countTick(double nowMs);
+	void countFrame(double nowMs);
+
+	double ticksPerSecond() const  { return m_ticksPerSecond; }
+	double framesPerSecond() const { return m_framesPerSecond; }
+	long long droppedFrames() const { return m_droppedFrames; }
+
+	double mean(Series series) const;
+	double percentile(Series series, double p) const;
+
+	  // One line for the on-screen overlay
+	std::string summary() const;
+	bool dump(std::string path) const;
+
+private:
+	struct Window
+	{
+		std::vector<float> samples;
+		int next;
+		int count;
+		double sum;
+	};
+
+	Window    m_windows[NUM_SERIES];
+	double    m_msPerFrame;
+	double    m_rateStartMs;
+	int       m_ticksSinceRate;
+	int       m_framesSinceRate;
+	double    m_ticksPerSecond;
+	double    m_framesPerSecond;
+	long long m_droppedFrames;
+	long long m_totalFrames;
+	long long m_totalTicks;
+
+	void updateRates(double nowMs);
+};
+
+#endif // PERFSTATS_H_
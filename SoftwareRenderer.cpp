@@ -0,0 +1,183 @@
+#include "SoftwareRenderer.h"
+#include "AssetManifest.h"
+#include "AssetPack.h"
+#include "GameConstants.h"
+#include "GraphObject.h"
+#include <iostream>
+#include <algorithm>
+using namespace std;
+
+static const int MAX_FRAMES_PER_SPRITE = 100;
+
+SoftwareRenderer::SoftwareRenderer(int scale)
+{
+    m_scale = (scale < 1) ? 1 : scale;
+    m_width = VIEW_WIDTH * m_scale;
+    m_height = VIEW_HEIGHT * m_scale;
+    m_framebuffer.assign(static_cast<size_t>(m_width) * m_height * 4, 0);
+}
+
+bool SoftwareRenderer::loadSprite(string filename_tga, int imageID, int frameNum)
+{
+    TgaImage image;
+    if (!loadTga(filename_tga, image))
+        return false;
+    m_images[getSpriteID(imageID, frameNum)] = std::move(image);
+    m_frameCountPerSprite[imageID]++;
+    return true;
+}
+
+bool SoftwareRenderer::loadAllSprites(string assetPath)
+{
+    for (const auto& d : SPRITE_ASSETS)
+    {
+        if (!loadSprite(assetPath + d.tgaFileName, d.imageID, d.frameNum))
+        {
+            cerr << "***** Error loading sprite: " << (assetPath + d.tgaFileName) << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SoftwareRenderer::loadAllSprites(const AssetPack& pack)
+{
+    for (const auto& d : SPRITE_ASSETS)
+    {
+        AssetPack::Sprite sprite;
+        if (!pack.findSprite(d.tgaFileName, sprite))
+        {
+            cerr << "***** Asset pack has no sprite " << d.tgaFileName << endl;
+            return false;
+        }
+        TgaImage& image = m_images[getSpriteID(d.imageID, d.frameNum)];
+        image.width = sprite.width;
+        image.height = sprite.height;
+        image.rgba.assign(sprite.rgba, sprite.rgba + static_cast<size_t>(sprite.width) * sprite.height * 4);
+        m_frameCountPerSprite[d.imageID]++;
+    }
+    return true;
+}
+
+int SoftwareRenderer::getNumFrames(int imageID) const
+{
+    auto it = m_frameCountPerSprite.find(imageID);
+    if (it == m_frameCountPerSprite.end())
+        return 0;
+    return it->second;
+}
+
+int SoftwareRenderer::width() const
+{
+    return m_width;
+}
+
+int SoftwareRenderer::height() const
+{
+    return m_height;
+}
+
+void SoftwareRenderer::renderGraphObjects()
+{
+    clear();
+    for (int i = GraphObject::NUM_DEPTHS - 1; i >= 0; --i)
+    {
+        for (GraphObject* cur : GraphObject::getGraphObjects(i))
+            drawGraphObject(cur);
+    }
+}
+
+void SoftwareRenderer::renderGraphObjects(const std::vector<GraphObject*>& objects)
+{
+    clear();
+    for (GraphObject* cur : objects)
+        drawGraphObject(cur);
+}
+
+void SoftwareRenderer::drawGraphObject(GraphObject* cur)
+{
+    if (!cur->isVisible())
+        return;
+    cur->animate();
+
+    int numFrames = getNumFrames(cur->getID());
+    if (numFrames == 0)
+        return;
+    double x, y;
+    cur->getAnimationLocation(x, y);
+    plotSprite(cur->getID(), cur->getAnimationNumber() % numFrames,
+               static_cast<int>(x), static_cast<int>(y), cur->getDirection(), cur->getSize(), cur->getBrightness());
+}
+
+void SoftwareRenderer::clear()
+{
+    std::fill(m_framebuffer.begin(), m_framebuffer.end(), 0);
+    for (size_t i = 3; i < m_framebuffer.size(); i += 4)
+        m_framebuffer[i] = 255;
+}
+
+bool SoftwareRenderer::plotSprite(int imageID, int frame, int x, int y, int angleDegrees, double size,
+                                  double brightness)
+{
+    auto it = m_images.find(getSpriteID(imageID, frame));
+    if (it == m_images.end())
+        return false;
+    const TgaImage& image = it->second;
+
+    // The sprite covers one board cell whose lower-left corner is (x, y),
+    // grown or shrunk about its center by size
+    int side = static_cast<int>(SPRITE_WIDTH * m_scale * size + 0.5);
+    if (side <= 0)
+        return true;
+    int centerX = (x * 2 + SPRITE_WIDTH) * m_scale / 2;
+    int centerY = (y * 2 + SPRITE_HEIGHT) * m_scale / 2;
+    int left = centerX - side / 2;
+    int bottom = centerY - side / 2;
+    // Brightness scales the sprite's color, in 1/256 steps
+    int shade = static_cast<int>(std::min(std::max(brightness, 0.0), 1.0) * 256);
+
+    for (int dy = 0; dy < side; dy++)
+    {
+        int fbY = m_height - 1 - (bottom + dy);
+        if (fbY < 0 || fbY >= m_height)
+            continue;
+        for (int dx = 0; dx < side; dx++)
+        {
+            int fbX = left + dx;
+            if (fbX < 0 || fbX >= m_width)
+                continue;
+
+            // Map the destination pixel back into the unrotated sprite; actors
+            // facing left are mirrored rather than drawn upside-down
+            int u, v;
+            switch (angleDegrees)
+            {
+                default:  u = dx;            v = dy;            break;
+                case 180: u = side - 1 - dx; v = dy;            break;
+                case 90:  u = dy;            v = side - 1 - dx; break;
+                case 270: u = side - 1 - dy; v = dx;            break;
+            }
+            int srcX = u * image.width / side;
+            int srcY = v * image.height / side;
+            const unsigned char* src = &image.rgba[(static_cast<size_t>(srcY) * image.width + srcX) * 4];
+            unsigned char* dst = &m_framebuffer[(static_cast<size_t>(fbY) * m_width + fbX) * 4];
+
+            int alpha = src[3];
+            if (alpha == 0)
+                continue;
+            for (int c = 0; c < 3; c++)
+                dst[c] = static_cast<unsigned char>(((src[c] * shade >> 8) * alpha + dst[c] * (255 - alpha)) / 255);
+        }
+    }
+    return true;
+}
+
+const vector<unsigned char>& SoftwareRenderer::pixels() const
+{
+    return m_framebuffer;
+}
+
+int SoftwareRenderer::getSpriteID(int imageID, int frame)
+{
+    return imageID * MAX_FRAMES_PER_SPRITE + frame;
+}
@@ -0,0 +1,52 @@
+#ifndef SOFTWARERENDERER_H_
+#define SOFTWARERENDERER_H_
+
+#include "TgaDecoder.h"
+#include <string>
+#include <vector>
+#include <map>
+
+class GraphObject;
+class AssetPack;
+
+// Composites the game's sprites into an RGBA framebuffer on the CPU, so
+// frames can be captured on machines without an OpenGL context.
+
+class SoftwareRenderer
+{
+public:
+    SoftwareRenderer(int scale = 1);
+
+    bool loadSprite(std::string filename_tga, int imageID, int frameNum);
+    bool loadAllSprites(std::string assetPath);
+    bool loadAllSprites(const AssetPack& pack);
+    int getNumFrames(int imageID) const;
+
+    int width() const;
+    int height() const;
+
+    // Draw every visible GraphObject, deepest layer first, like displayGamePlay
+    void renderGraphObjects();
+    // Draw the given objects in order, for builds that don't register them
+    void renderGraphObjects(const std::vector<GraphObject*>& objects);
+
+    void clear();
+    bool plotSprite(int imageID, int frame, int x, int y, int angleDegrees, double size,
+                    double brightness = 1.0);
+
+    // RGBA, 4 bytes per pixel, top row first
+    const std::vector<unsigned char>& pixels() const;
+private:
+    void drawGraphObject(GraphObject* object);
+
+    int m_scale;
+    int m_width;
+    int m_height;
+    std::vector<unsigned char> m_framebuffer;
+    std::map<int, TgaImage> m_images;
+    std::map<int, int> m_frameCountPerSprite;
+
+    static int getSpriteID(int imageID, int frame);
+};
+
+#endif // SOFTWARERENDERER_H_
@@ -0,0 +1,128 @@
+#ifndef SOUNDBUS_H_
+#define SOUNDBUS_H_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+
+struct SoundEvent
+{
+	long long tick;
+	int       soundID;
+};
+
+class SoundListener
+{
+  public:
+	virtual ~SoundListener() {}
+	virtual void onSound(const SoundEvent& event) = 0;
+};
+
+  // Each world owns a bus that its sound requests are published on.  With
+  // no subscribers an emit is a single untaken branch.  Repeats of the same
+  // sound within the coalescing window are dropped before delivery.
+
+class SoundBus
+{
+  public:
+
+	SoundBus()
+	 : m_coalesceTicks(0), m_coalesced(0)
+	{
+	}
+
+	void subscribe(SoundListener* listener)
+	{
+		m_listeners.push_back(listener);
+	}
+
+	void unsubscribe(SoundListener* listener)
+	{
+		m_listeners.erase(std::remove(m_listeners.begin(), m_listeners.end(), listener), m_listeners.end());
+	}
+
+	  // A sound repeated less than this many ticks after its last delivery is
+	  // dropped; 0 delivers everything
+	void setCoalesceWindow(int ticks)
+	{
+		m_coalesceTicks = ticks;
+	}
+
+	void emit(long long tick, int soundID)
+	{
+		if (m_listeners.empty())
+			return;
+		publish(tick, soundID);
+	}
+
+	long long coalescedCount() const
+	{
+		return m_coalesced;
+	}
+
+  private:
+	std::vector<SoundListener*> m_listeners;
+	std::vector<long long>      m_lastDelivered;  // indexed by sound ID
+	int                         m_coalesceTicks;
+	long long                   m_coalesced;
+
+	void publish(long long tick, int soundID)
+	{
+		if (soundID < 0)
+			return;
+		if (m_coalesceTicks > 0)
+		{
+			if (soundID >= static_cast<int>(m_lastDelivered.size()))
+				m_lastDelivered.resize(soundID + 1, -1);
+			long long& last = m_lastDelivered[soundID];
+			if (last >= 0  &&  tick - last < m_coalesceTicks)
+			{
+				m_coalesced++;
+				return;
+			}
+			last = tick;
+		}
+
+		SoundEvent event = { tick, soundID };
+		for (SoundListener* listener : m_listeners)
+			listener->onSound(event);
+	}
+};
+
+  // Keeps every sound event, e.g. for replays or analytics
+
+class SoundRecorder : public SoundListener
+{
+  public:
+	virtual void onSound(const SoundEvent& event)
+	{
+		m_events.push_back(event);
+	}
+
+	const std::vector<SoundEvent>& events() const
+	{
+		return m_events;
+	}
+
+	void clear()
+	{
+		m_events.clear();
+	}
+
+	  // One "tick,sound" line per event
+	bool save(const std::string& filename, bool append = false) const
+	{
+		std::ofstream out(filename, append ? std::ios::app : std::ios::trunc);
+		if (!out)
+			return false;
+		for (const SoundEvent& e : m_events)
+			out << e.tick << "," << e.soundID << "\n";
+		return static_cast<bool>(out);
+	}
+
+  private:
+	std::vector<SoundEvent> m_events;
+};
+
+#endif // SOUNDBUS_H_
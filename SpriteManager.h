@@ -8,18 +8,11 @@
 
 #include "freeglut.h"
 
-#ifndef GL_BGR
-#define GL_BGR GL_BGR_EXT
-#endif
-
-#ifndef GL_BGRA
-#define GL_BGRA GL_BGRA_EXT
-#endif
-
 #include "GameConstants.h"
+#include "TgaDecoder.h"
+#include "AssetPack.h"
 #include <cstring>
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <map>
 #include <memory>
@@ -48,96 +41,23 @@ public:
 			return false;
 		m_frameCountPerSprite[imageID]++;  // keep track of how many frames per sprite we loaded
 
-		std::string line;
-		std::string contents = "";
-		std::ifstream tgaFile(filename_tga, std::ios::in|std::ios::binary);
-
-		if (!tgaFile) {
-			std::cerr << "***** Unable to open " << filename_tga << std::endl;
+		TgaImage image;
+		if (!loadTga(filename_tga, image))
 			return false;
-		}
 
-		TGA_HEADER header;
-		tgaFile.read((char *)&header,sizeof(header));
-		unsigned char byteCount = static_cast<unsigned char>(header.pixel_depth) / 8;
-		const long imageSize = header.width_pixels * header.height_pixels * byteCount;
-
-		unsigned int textureWidth = header.width_pixels;
-		unsigned int textureHeight = header.height_pixels;
-
-		std::unique_ptr<char[]> imageData(new char[imageSize]);
-		tgaFile.seekg(18);
-		  // Read image data
-		tgaFile.read(imageData.get(), imageSize);
-		if (!tgaFile) {
-			std::cerr << "***** Unable to read " << imageSize << " (imageSize) bytes from file "
-		              << filename_tga << std::endl;
-			return false;
-		}
+		createTexture(spriteID, image.width, image.height, image.rgba.data(), nullptr);
+		return true;
+	}
 
-		// image type either 2 (color) or 3 (greyscale)
-		if (header.color_map_type != 0 || (header.image_type != 2 && header.image_type != 3)) {
-			std::cerr << "***** Bad color_map_type or image type in " << filename_tga << std::endl;
-			return false;
-		}
-  
-		if (byteCount != 3 && byteCount != 4) {
-			std::cerr << "***** Bad byte count " << byteCount << " in " << filename_tga << std::endl;
+	  // Same, for a sprite from an asset pack: its mipmaps are already built
+	bool loadSprite(const AssetPack::Sprite& sprite, int imageID, int frameNum)
+	{
+		int spriteID = getSpriteID(imageID, frameNum);
+		if (INVALID_SPRITE_ID == spriteID)
 			return false;
-		}
-
-		if (header.image_descriptor & 0x20) {
-		  // image is flipped vertically
-		  flipVertical(imageData.get(), header.width_pixels, header.height_pixels, byteCount);
-		}
-
-		// Transfer Texture To OpenGL
-
-		glEnable(GL_DEPTH_TEST);
-
-		  // allocate a texture handle
-		GLuint glTextureID;
-		glGenTextures(1, &glTextureID);
-
-		  // bind our new texture
-		glBindTexture(GL_TEXTURE_2D, glTextureID);
-
-		glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-
-		if (m_mipMapped)
-		{
-			  // when texture area is small, bilinear filter the closest mipmap
-			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-			  // when texture area is large, bilinear filter the first mipmap
-			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		}
-		else
-		{
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		}
-
-		  // Have the texture wrap both vertically and horizontally.
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_REPEAT));
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_REPEAT));
-
-		if (m_mipMapped)
-		{
-			  // build our texture mipmaps
-			  // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-			makeMipmaps(byteCount, textureWidth, textureHeight, imageData.get());
-		}
-		else
-		{
-			  // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-			if (3 == byteCount)
-				glTexImage2D(GL_TEXTURE_2D, 0, 3, textureWidth, textureHeight, 0, GL_BGR, GL_UNSIGNED_BYTE, imageData.get());
-			else if (4 == byteCount)
-				glTexImage2D(GL_TEXTURE_2D, 0, 4, textureWidth, textureHeight, 0, GL_BGRA, GL_UNSIGNED_BYTE, imageData.get());
-		}
-
-		m_imageMap[spriteID] = glTextureID;
+		m_frameCountPerSprite[imageID]++;
 
+		createTexture(spriteID, sprite.width, sprite.height, sprite.rgba, &sprite);
 		return true;
 	}
 
@@ -150,7 +70,8 @@ public:
 		return it->second;
 	}
 
-	bool plotSprite(int imageID, int frame, double gx, double gy, double gz, int angleDegrees, double size)
+	bool plotSprite(int imageID, int frame, double gx, double gy, double gz, int angleDegrees, double size,
+					double brightness = 1.0)
 	{
 		int spriteID = getSpriteID(imageID, frame);
 		if (INVALID_SPRITE_ID == spriteID)
@@ -178,7 +99,8 @@ public:
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		glBindTexture(GL_TEXTURE_2D, it->second);
 
-		glColor3f(1.0, 1.0, 1.0);
+		  // the texture is modulated by the current color
+		glColor3f(static_cast<GLfloat>(brightness), static_cast<GLfloat>(brightness), static_cast<GLfloat>(brightness));
 
 		double cx1,cx2,cx3,cx4;
 		double cy1,cy2,cy3,cy4;
@@ -259,23 +181,6 @@ public:
 
 private:
 
-#pragma pack(1)
-  struct TGA_HEADER {
-	unsigned char id_length;
-	unsigned char color_map_type;
-	unsigned char image_type;
-	unsigned short index_of_first_color_map_entry;
-	unsigned short color_map_length;
-	unsigned char color_map_entry_size;
-	unsigned short x_origin;
-	unsigned short y_origin;
-	unsigned short width_pixels;
-	unsigned short height_pixels;
-	unsigned char pixel_depth;
-	unsigned char image_descriptor; // bits 3-0 give alpha channel depth, and 5-4 give direction.
-  };
-#pragma pack()
-
 	bool                  m_mipMapped;
 	std::map<int, GLuint> m_imageMap;
 	std::map<int, int>    m_frameCountPerSprite;
@@ -284,6 +189,56 @@ private:
 	static const int MAX_IMAGES = 1000;
 	static const int MAX_FRAMES_PER_SPRITE = 100;
 
+	  // Transfer Texture To OpenGL
+	void createTexture(int spriteID, unsigned int textureWidth, unsigned int textureHeight, const unsigned char* rgba,
+					   const AssetPack::Sprite* packed)
+	{
+		glEnable(GL_DEPTH_TEST);
+
+		  // allocate a texture handle
+		GLuint glTextureID;
+		glGenTextures(1, &glTextureID);
+
+		  // bind our new texture
+		glBindTexture(GL_TEXTURE_2D, glTextureID);
+
+		glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+		if (m_mipMapped)
+		{
+			  // when texture area is small, bilinear filter the closest mipmap
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			  // when texture area is large, bilinear filter the first mipmap
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		}
+		else
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		}
+
+		  // Have the texture wrap both vertically and horizontally.
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_REPEAT));
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_REPEAT));
+
+		if (m_mipMapped  &&  packed != nullptr)
+		{
+			  // upload the prebuilt mipmaps
+			for (int level = 0; level < packed->mipLevels; level++)
+				glTexImage2D(GL_TEXTURE_2D, level, 4, std::max(1, packed->mipWidth >> level),
+							 std::max(1, packed->mipHeight >> level), 0, GL_RGBA, GL_UNSIGNED_BYTE, packed->mips[level]);
+		}
+		else if (m_mipMapped)
+		{
+			  // build our texture mipmaps
+			makeMipmaps(textureWidth, textureHeight, rgba);
+		}
+		else
+			glTexImage2D(GL_TEXTURE_2D, 0, 4, textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+
+		m_imageMap[spriteID] = glTextureID;
+	}
+
 	void rotate(double x, double y, double degrees, double &xout, double &yout)
 	{
 		double theta = degrees*1.0 / 360 * 2 * 3.14159;
@@ -291,14 +246,6 @@ private:
 		yout = y * cos(theta) + x * sin(theta);
 	}
   
-	void flipVertical(char* image, int width, int height, int bytes_per_pixel) {
-		int bytes_per_row = width * bytes_per_pixel;
-		for (int i = 0; i < height/2; i++)
-			std::swap_ranges(image + i * bytes_per_row,
-			                 image + (i+1) * bytes_per_row,
-							 image + (height-i-1) * bytes_per_row);
-	}
-
 	int getSpriteID(int imageID, int frame) const
 	{
 		if (imageID >= MAX_IMAGES || frame >= MAX_FRAMES_PER_SPRITE)
@@ -307,17 +254,15 @@ private:
 		return imageID * MAX_FRAMES_PER_SPRITE + frame;
 	}
 
-    static void makeMipmaps(unsigned char byteCount, unsigned int textureWidth, unsigned int textureHeight, char* imageData)
-    {
-        int format = (byteCount == 3 ? GL_BGR : GL_BGRA);
+	static void makeMipmaps(unsigned int textureWidth, unsigned int textureHeight, const unsigned char* rgba)
+	{
 #ifdef __APPLE__
-        int internalFormat = (byteCount == 3 ? GL_RGB : GL_RGBA);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, textureWidth, textureHeight, 0, format, GL_UNSIGNED_BYTE, imageData);
-        glGenerateMipmap(GL_TEXTURE_2D);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+		glGenerateMipmap(GL_TEXTURE_2D);
 #else
-        gluBuild2DMipmaps(GL_TEXTURE_2D, byteCount, textureWidth, textureHeight, format, GL_UNSIGNED_BYTE, imageData);
+		gluBuild2DMipmaps(GL_TEXTURE_2D, 4, textureWidth, textureHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
 #endif
-    }
+	}
 };
 
 #if defined (__APPLE__)
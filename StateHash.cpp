@@ -0,0 +1,57 @@
+#include "StateHash.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+using namespace std;
+
+void writeWorldState(ostream& out, const WorldState& state)
+{
+    out << "#hash " << state.tick << " " << hex << setfill('0') << setw(16) << state.hash << " " << setw(16)
+        << state.board << dec << setfill(' ') << "\n";
+    for (const ActorState& actor : state.actors)
+    {
+        out << "#actor " << state.tick << " " << actor.name << " " << actor.x << " " << actor.y << " " << actor.coins
+            << " " << actor.stars << " " << hex << setfill('0') << setw(16) << actor.hash << dec << setfill(' ')
+            << "\n";
+    }
+}
+
+bool readWorldStates(const string& path, vector<WorldState>& states)
+{
+    ifstream in(path);
+    if (!in)
+        return false;
+    states.clear();
+    string line;
+    while (getline(in, line))
+    {
+        bool isHash = (line.compare(0, 6, "#hash ") == 0);
+        bool isActor = (line.compare(0, 7, "#actor ") == 0);
+        if (!isHash && !isActor)
+            continue;
+        istringstream iss(line.substr(isHash ? 6 : 7));
+        long long tick;
+        if (!(iss >> tick))
+            return false;
+        if (isHash)
+        {
+            WorldState state;
+            state.tick = tick;
+            if (!(iss >> hex >> state.hash >> state.board))
+                return false;
+            states.push_back(state);
+        }
+        else
+        {
+            ActorState actor;
+            if (states.empty() || states.back().tick != tick ||
+                !(iss >> actor.name >> actor.x >> actor.y >> actor.coins >> actor.stars >> hex >> actor.hash))
+                return false;
+            states.back().actors.push_back(actor);
+        }
+    }
+    stable_sort(states.begin(), states.end(),
+                [](const WorldState& a, const WorldState& b) { return a.tick < b.tick; });
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef STATEHASH_H_
+#define STATEHASH_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+// Zobrist hashing of a world's state.  Every piece of state (an actor's
+// position, a player's coins, a square's kind, the bank) has a pseudo-random
+// 64-bit key for each value it can take, and the state hash is the XOR of the
+// keys of the current values.  A change XORs the old value's key out and the
+// new one's in, so keeping the hash costs O(changes) per tick.  Keys are
+// computed by mixing rather than looked up, so they need no tables.
+enum StateField {
+    hash_position, hash_coins, hash_stars, hash_square, hash_bank
+};
+
+// The key for field of actor or cell id having value
+inline uint64_t stateKey(int field, int id, long long value)
+{
+    // splitmix64's finalizer
+    uint64_t z = (static_cast<uint64_t>(field) << 56) ^ (static_cast<uint64_t>(id) << 32) ^
+                 static_cast<uint64_t>(value);
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+inline long long packPosition(int x, int y)
+{
+    return (static_cast<long long>(x & 0xffff) << 16) | (y & 0xffff);
+}
+
+// One actor's part of a snapshot
+struct ActorState
+{
+    std::string name;        // "player2", or type and actor id, e.g. "boo5"
+    int x;
+    int y;
+    int coins;               // players only, else -1
+    int stars;
+    uint64_t hash;
+};
+
+// A world's state hash at the end of a tick, with each actor's share of it
+// so that runs that part ways can be told apart actor by actor
+struct WorldState
+{
+    long long tick = 0;
+    uint64_t hash = 0;       // everything
+    uint64_t board = 0;      // squares and the bank
+    std::vector<ActorState> actors;
+};
+
+// Snapshots are kept in action logs as comment lines, which replays skip:
+//   #hash TICK HASH BOARD
+//   #actor TICK NAME X Y COINS STARS HASH     (one per actor)
+void writeWorldState(std::ostream& out, const WorldState& state);
+
+// Reads the snapshots from an action log, in tick order; false if it can't
+// be read or a snapshot line is malformed
+bool readWorldStates(const std::string& path, std::vector<WorldState>& states);
+
+#endif // STATEHASH_H_
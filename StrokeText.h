@@ -0,0 +1,111 @@
+#ifndef STROKETEXT_H_
+#define STROKETEXT_H_
+
+#if defined (__APPLE__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+#include "freeglut.h"
+#include <string>
+
+  // One line of Roman stroke-font text whose geometry is compiled into a
+  // display list.  The list is rebuilt only when the text changes, and it
+  // is built out of per-glyph lists that are compiled once per program, so
+  // redrawing an unchanged line is a single glCallList.
+
+class StrokeTextLine
+{
+  public:
+
+	StrokeTextLine()
+	 : m_list(0), m_length(0)
+	{
+	}
+
+	~StrokeTextLine()
+	{
+		if (m_list != 0)
+			glDeleteLists(m_list, 1);
+	}
+
+	  // Same placement as the old glutStrokeCharacter loop: centered
+	  // horizontally, at height y and depth z, scaled down by scaleDown.
+	void drawCentered(double y, double z, double scaleDown, const std::string& text)
+	{
+		if (m_list == 0  ||  text != m_text)
+			rebuild(text);
+
+		GLfloat scaledSize = static_cast<GLfloat>(1 / scaleDown);
+		glPushMatrix();
+		glLineWidth(1);
+		glLoadIdentity();
+		glTranslatef(static_cast<GLfloat>(-m_length / scaleDown / 2), static_cast<GLfloat>(y), static_cast<GLfloat>(z));
+		glScalef(scaledSize, scaledSize, scaledSize);
+		glCallList(m_list);
+		glPopMatrix();
+	}
+
+  private:
+	  // Prevent copying or assigning; each line owns a display list
+	StrokeTextLine(const StrokeTextLine&);
+	StrokeTextLine& operator=(const StrokeTextLine&);
+
+	static const int NUM_GLYPHS = 128;
+
+	std::string m_text;
+	GLuint      m_list;
+	double      m_length;  // in unscaled stroke units
+
+	struct Glyphs
+	{
+		GLuint base;
+		int    width[NUM_GLYPHS];
+	};
+
+	static const Glyphs& glyphs()
+	{
+		static Glyphs g = buildGlyphs();
+		return g;
+	}
+
+	static Glyphs buildGlyphs()
+	{
+		Glyphs g;
+		g.base = glGenLists(NUM_GLYPHS);
+		for (int c = 0; c < NUM_GLYPHS; c++)
+		{
+			  // each glyph list draws the character and advances past it
+			glNewList(g.base + c, GL_COMPILE);
+			glutStrokeCharacter(GLUT_STROKE_ROMAN, c);
+			glEndList();
+			g.width[c] = glutStrokeWidth(GLUT_STROKE_ROMAN, c);
+		}
+		return g;
+	}
+
+	void rebuild(const std::string& text)
+	{
+		const Glyphs& g = glyphs();
+		if (m_list == 0)
+			m_list = glGenLists(1);
+
+		m_text = text;
+		m_length = 0;
+		glNewList(m_list, GL_COMPILE);
+		for (unsigned char c : text)
+		{
+			if (c >= NUM_GLYPHS)
+				continue;
+			glCallList(g.base + c);
+			m_length += g.width[c];
+		}
+		glEndList();
+	}
+};
+
+#if defined (__APPLE__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // STROKETEXT_H_
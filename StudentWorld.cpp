@@ -1,10 +1,13 @@
 #include "StudentWorld.h"
 #include "GameConstants.h"
 #include "Actor.h"
+#include "AssetPack.h"
 #include <string>
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <algorithm>
+#include <chrono>
 using namespace std;
 
 GameWorld* createStudentWorld(string assetPath)
@@ -15,9 +18,29 @@ GameWorld* createStudentWorld(string assetPath)
 StudentWorld::StudentWorld(string assetPath)
  : GameWorld(assetPath)
 {
-    m_peach = nullptr;
-    m_yoshi = nullptr;
+    m_winner = 0;
     m_bank = 0;
+    m_stateHash = 0;
+    m_boardHash = 0;
+    m_nextActorID = 1;
+    m_heatmap = nullptr;
+    m_economyLog = nullptr;
+    fill(begin(m_eventCounts), end(m_eventCounts), 0);
+    m_presetBoard = nullptr;
+    m_heatmapOverlay = false;
+    m_awakeUnsorted = false;
+    m_macroStepping = false;
+    m_vorticesInFlight = 0;
+    m_actorUpdates = 0;
+    m_movesSinceTimed = 0;
+    for (int i = 0; i < BOARD_WIDTH; i++)
+    {
+        for (int j = 0; j < BOARD_HEIGHT; j++)
+        {
+            m_squareIndex[i][j] = -1;
+            m_cellPlayers[i][j] = 0;
+        }
+    }
 }
 
 StudentWorld::~StudentWorld()
@@ -28,25 +51,42 @@ StudentWorld::~StudentWorld()
 int StudentWorld::init()
 {
     Board bd;
+    if (m_heatmap == &m_overlayHeatmap)
+        m_overlayHeatmap.clear();
+    fill(begin(m_eventCounts), end(m_eventCounts), 0);
+    m_timers.reset(getTickCount());
+    m_boardHash = stateKey(hash_bank, 0, m_bank);
+    m_stateHash = m_boardHash;
     
-    // Get filepath to board data file
-    ostringstream oss;
-    oss << assetPath() << "board0" << getBoardNumber() << ".txt";
-    string board_file = oss.str();
-    
-    // Load board
-    Board::LoadResult result = bd.loadBoard(board_file);
-    if (result == Board::load_fail_file_not_found)
-    {
-        cerr << "Could not find data file\n";
-        return GWSTATUS_BOARD_ERROR;
-    }
-    else if (result == Board::load_fail_bad_format)
+    if (m_presetBoard != nullptr)
+        bd = *m_presetBoard;
+    else
     {
-        cerr << "Your board was improperly formatted\n";
-        return GWSTATUS_BOARD_ERROR;
+        // Get filepath to board data file
+        ostringstream oss;
+        oss << "board0" << getBoardNumber() << ".txt";
+        string board_file = oss.str();
+        
+        // Load board, from the asset pack if there is one
+        Board::LoadResult result = Board::load_fail_file_not_found;
+        const unsigned char* text;
+        size_t length;
+        if (assetPack() == nullptr)
+            result = bd.loadBoard(assetPath() + board_file);
+        else if (assetPack()->findFile(board_file, text, length))
+            result = bd.parseBoard(reinterpret_cast<const char*>(text), length);
+        if (result == Board::load_fail_file_not_found)
+        {
+            cerr << "Could not find data file\n";
+            return GWSTATUS_BOARD_ERROR;
+        }
+        else if (result == Board::load_fail_bad_format)
+        {
+            cerr << "Your board was improperly formatted\n";
+            return GWSTATUS_BOARD_ERROR;
+        }
     }
-    cerr << "Successfully loaded board\n";
+    worldLog("Successfully loaded board\n");
     
     // Populate board with actors
     for (int i = 0; i < BOARD_WIDTH; i++)
@@ -58,68 +98,72 @@ int StudentWorld::init()
             {
                 case Board::player:
                 {
-                    m_peach = new Player(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, 1);
-                    m_actorContainer.push_back(m_peach);
-                    m_yoshi = new Player(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, 2);
-                    m_actorContainer.push_back(m_yoshi);
-                    m_actorContainer.push_back(new CoinSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, true));
+                    for (int playerNum = 1; playerNum <= getNumPlayers(); playerNum++)
+                    {
+                        Player* player = new Player(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, playerNum);
+                        m_players.push_back(player);
+                        addActor(player, metric_players_alive);
+                    }
+                    m_playerSquare.assign(getNumPlayers(), -1);
+                    m_playerCell.assign(getNumPlayers(), -1);
+                    addSquare(coin_square, i, j, 3);
                     break;
                 }
                 case Board::blue_coin_square:
                 {
-                    m_actorContainer.push_back(new CoinSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, true));
+                    addSquare(coin_square, i, j, 3);
                     break;
                 }
                 case Board::red_coin_square:
                 {
-                    m_actorContainer.push_back(new CoinSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, false));
+                    addSquare(coin_square, i, j, -3);
                     break;
                 }
                 case Board::star_square:
                 {
-                    m_actorContainer.push_back(new StarSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j));
+                    addSquare(star_square, i, j);
                     break;
                 }
                 case Board::up_dir_square:
                 {
-                    m_actorContainer.push_back(new DirSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, DirSquare::up));
+                    addSquare(dir_square, i, j, 0, GraphObject::up);
                     break;
                 }
                 case Board::down_dir_square:
                 {
-                    m_actorContainer.push_back(new DirSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, DirSquare::down));
+                    addSquare(dir_square, i, j, 0, GraphObject::down);
                     break;
                 }
                 case Board::left_dir_square:
                 {
-                    m_actorContainer.push_back(new DirSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, DirSquare::left));
+                    addSquare(dir_square, i, j, 0, GraphObject::left);
                     break;
                 }
                 case Board::right_dir_square:
                 {
-                    m_actorContainer.push_back(new DirSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, DirSquare::right));
+                    addSquare(dir_square, i, j, 0, GraphObject::right);
                     break;
                 }
                 case Board::bank_square:
                 {
-                    m_actorContainer.push_back(new BankSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j));
+                    addSquare(bank_square, i, j);
                     break;
                 }
                 case Board::event_square:
                 {
-                    m_actorContainer.push_back(new EventSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j));
+                    addSquare(event_square, i, j);
                     break;
                 }
                 case Board::bowser:
                 {
-                    m_actorContainer.push_back(new Bowser(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j));
-                    m_actorContainer.push_back(new CoinSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, true));
+                    addActor(new Bowser(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j), metric_bowsers_alive);
+                    addSquare(coin_square, i, j, 3);
                     break;
                 }
                 case Board::boo:
                 {
-                    m_actorContainer.push_back(new Boo(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j));
-                    m_actorContainer.push_back(new CoinSquare(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j, true));
+                    addActor(new Boo(this, SPRITE_WIDTH * i, SPRITE_HEIGHT * j), metric_boos_alive);
+                    addSquare(coin_square, i, j, 3);
                     break;
                 }
                 case Board::empty:
@@ -131,76 +175,111 @@ int StudentWorld::init()
     return GWSTATUS_CONTINUE_GAME;
 }
 
+// While someone is watching the metrics, one tick in MOVE_SAMPLE_INTERVAL is
+// timed for the average; reading the clock every tick would cost more than
+// many ticks do
 int StudentWorld::move()
 {
-    // Ask all actors to do something
-    list<Actor*>::iterator p = m_actorContainer.begin();
-    while (p != m_actorContainer.end())
+    Metrics::add(metric_moves);
+    Metrics::add(metric_ticks);
+    if (!Metrics::enabled() || ++m_movesSinceTimed < MOVE_SAMPLE_INTERVAL)
+        return playTick();
+    m_movesSinceTimed = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int status = playTick();
+    Metrics::add(metric_timed_moves);
+    Metrics::add(metric_move_ns, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+    return status;
+}
+
+int StudentWorld::playTick()
+{
+    advanceTick();
+    
+    updatePlayerCells();
+    wakeDueActors();
+    
+    // Ask the awake actors to do something, in actor list order, then move
+    // every mover that asked to in one pass, then let squares act on where
+    // the players ended up.  Actors woken or added during the loop (fired
+    // vortices) first act next tick.
+    if (m_awakeUnsorted)
     {
-        (*p)->doSomething();
-        p++;
+        sort(m_awake.begin(), m_awake.end(),
+             [](const Actor* a, const Actor* b) { return a->m_actorSlot < b->m_actorSlot; });
+        m_awakeUnsorted = false;
     }
+    size_t numAwake = m_awake.size();
+    for (size_t i = 0; i < numAwake; i++)
+        m_awake[i]->doSomething();
+    m_actorUpdates += numAwake;
     
-    // Remove inactive/dead game objects
-    list<Actor*>::iterator d = m_actorContainer.begin();
-    while (d != m_actorContainer.end())
+    // Actors with nothing to do for a while sleep until their timer runs out
+    // or something wakes them.  When macro-stepping, so do movers walking to
+    // the next square; they catch up on the steps they missed when they wake.
+    size_t numKept = 0;
+    for (size_t i = 0; i < m_awake.size(); i++)
     {
-        if (!(*d)->isAlive())
-        {
-            delete *d;
-            d = m_actorContainer.erase(d);
-            cerr << "Deleted object\n";
-        }
+        Actor* actor = m_awake[i];
+        int idleTicks = (i < numAwake) ? actor->idleTicks() : 0;
+        int coastTicks = (idleTicks == 0 && i < numAwake && m_macroStepping) ? actor->coastTicks() : 0;
+        if (idleTicks != 0)
+            sleepActor(actor, idleTicks);
+        else if (coastTicks > 0)
+            sleepActor(actor, coastTicks, true);
         else
-            d++;
+            m_awake[numKept++] = actor;
     }
+    m_awake.resize(numKept);
     
-    // Determine if Peach and Yoshi have vortexes
-    string peachVortex = "";
-    if (m_peach->hasVortex())
-        peachVortex = " VOR";
-    string yoshiVortex = "";
-    if (m_yoshi->hasVortex())
-        yoshiVortex = " VOR";
+    m_movers.stepAll();
+    const vector<int>& stepped = m_movers.getStepped();
+    for (int slot : stepped)
+        m_movers.getOwner(slot)->finishStep();
+    for (int slot : stepped)
+        m_movers.getOwner(slot)->afterStep();
+    activateSquares();
+    if (m_heatmapOverlay)
+        tintSquares();
     
-    // Update text
-    ostringstream oss;
-    oss << "P1 Roll: " << m_peach->squaresToMove() << " Stars: " << m_peach->getStars() << " $$: " << m_peach->getCoins() << peachVortex << " | Time: " << timeRemaining() << " | Bank: " << m_bank << " | P2 Roll: " << m_yoshi->squaresToMove() << " Stars: " << m_yoshi->getStars() << " $$: " << m_yoshi->getCoins() << yoshiVortex;
-    string text = oss.str();
-    setGameStatText(text);
+    reclaimDead();
+    
+    if (WorldPolicy::hud)
+        updateStatusText();
     
     // Check if game is over
     if (timeRemaining() <= 0)
     {
         playSound(SOUND_GAME_FINISHED);
         
-        // Determine winner
-        int winner;
-        if (m_peach->getStars() > m_yoshi->getStars())
-            winner = 1;
-        else if (m_yoshi->getStars() > m_peach->getStars())
-            winner = 2;
-        else
+        // Determine winner: most stars, then most coins, then at random
+        vector<int> leaders;
+        for (Player* player : m_players)
         {
-            if (m_peach->getCoins() > m_yoshi->getCoins())
-                winner = 1;
-            else if (m_yoshi->getCoins() > m_peach->getCoins())
-                winner = 2;
-            else
-                winner = randInt(1, 2);
+            if (!leaders.empty())
+            {
+                Player* leader = m_players[leaders[0] - 1];
+                if (player->getStars() < leader->getStars() ||
+                    (player->getStars() == leader->getStars() && player->getCoins() < leader->getCoins()))
+                    continue;
+                if (player->getStars() > leader->getStars() || player->getCoins() > leader->getCoins())
+                    leaders.clear();
+            }
+            leaders.push_back(player->getPlayerNum());
         }
+        if (leaders.size() == 1)
+            m_winner = leaders[0];
+        else
+            m_winner = leaders[randInt(1, static_cast<int>(leaders.size())) - 1];
         
         // Set final score and return winner
-        if (winner == 1)
-        {
-            setFinalScore(m_peach->getStars(), m_peach->getCoins());
+        Player* winner = m_players[m_winner - 1];
+        setFinalScore(winner->getStars(), winner->getCoins());
+        if (m_winner == 1)
             return GWSTATUS_PEACH_WON;
-        }
-        else
-        {
-            setFinalScore(m_yoshi->getStars(), m_yoshi->getCoins());
+        if (m_winner == 2)
             return GWSTATUS_YOSHI_WON;
-        }
+        return GWSTATUS_PLAYER_WON;
     }
     
 	return GWSTATUS_CONTINUE_GAME;
@@ -209,58 +288,94 @@ int StudentWorld::move()
 void StudentWorld::cleanUp()
 {
     // Remove all actors
-    list<Actor*>::iterator p = m_actorContainer.begin();
-    while (p != m_actorContainer.end())
+    for (Actor* actor : m_actorContainer)
     {
-        delete *p;
-        p = m_actorContainer.erase(p);
+        Metrics::add(static_cast<MetricId>(actor->m_aliveMetric), -1);
+        delete actor;
     }
+    m_actorContainer.clear();
+    m_graveyard.clear();
+    m_awake.clear();
+    m_vorticesInFlight = 0;
+    m_timers.reset(getTickCount());
+    for (int i = 0; i < BOARD_WIDTH; i++)
+        for (int j = 0; j < BOARD_HEIGHT; j++)
+            m_cellSleepers[i][j].clear();
+    for (Vortex* vortex : m_vortexPool)
+        delete vortex;
+    m_vortexPool.clear();
+    
+    // Remove all squares
+    for (GraphObject* sprite : m_squareSprites)
+        delete sprite;
+    m_squareSprites.clear();
+    m_squares.clear();
+    for (int i = 0; i < BOARD_WIDTH; i++)
+        for (int j = 0; j < BOARD_HEIGHT; j++)
+            m_squareIndex[i][j] = -1;
+    m_players.clear();
+    m_playerSquare.clear();
+    m_playerCell.clear();
+    for (int i = 0; i < BOARD_WIDTH; i++)
+        for (int j = 0; j < BOARD_HEIGHT; j++)
+            m_cellPlayers[i][j] = 0;
+    m_stateHash = 0;
+    m_boardHash = 0;
+    m_nextActorID = 1;
 }
 
-bool StudentWorld::squareHasCoordinates(int x, int y)
+bool StudentWorld::squareHasCoordinates(int x, int y) const
 {
-    list<Actor*>::iterator p = m_actorContainer.begin();
-    while (p != m_actorContainer.end())
-    {
-        // If a square's coordinates match arguments, return true
-        if ((*p)->isSquare() && (*p)->getX() == x && (*p)->getY() == y)
-            return true;
-        p++;
-    }
-    return false;
+    return squareAt(x, y) >= 0;
 }
 
-Actor* StudentWorld::chooseRandomSquare()
+void StudentWorld::chooseRandomSquare(int& x, int& y)
 {
-    // Create a temporary vector of just squares
-    list<Actor*>::iterator p = m_actorContainer.begin();
-    vector<Actor*> squareContainer;
-    while (p != m_actorContainer.end())
-    {
-        if ((*p)->isSquare())
-            squareContainer.push_back(*p);
-        p++;
-    }
-    // Choose and return random square
-    int squareIndex = randInt(1, static_cast<int>(squareContainer.size()));
-    return squareContainer[squareIndex - 1];
+    int squareIndex = randInt(1, static_cast<int>(m_squares.size()));
+    x = m_squares[squareIndex - 1].x;
+    y = m_squares[squareIndex - 1].y;
 }
 
-Player* StudentWorld::getPeach() const
+const vector<Square>& StudentWorld::getSquares() const
 {
-    return m_peach;
+    return m_squares;
 }
 
-Player* StudentWorld::getYoshi() const
+MoverStore& StudentWorld::getMovers()
 {
-    return m_yoshi;
+    return m_movers;
+}
+
+Player* StudentWorld::getPlayer(int playerNum) const
+{
+    return m_players[playerNum - 1];
 }
 
 Player* StudentWorld::getOtherPlayer(Player* player) const
 {
-    if (player == m_peach)
-        return m_yoshi;
-    return m_peach;
+    int numPlayers = static_cast<int>(m_players.size());
+    if (numPlayers == 2)
+        return m_players[2 - player->getPlayerNum()];
+    int other = randInt(1, numPlayers - 1);
+    if (other >= player->getPlayerNum())
+        other++;
+    return m_players[other - 1];
+}
+
+uint64_t StudentWorld::getPlayersAt(int x, int y) const
+{
+    if (x < 0 || y < 0 || x % SPRITE_WIDTH != 0 || y % SPRITE_HEIGHT != 0)
+        return 0;
+    int i = x / SPRITE_WIDTH;
+    int j = y / SPRITE_HEIGHT;
+    if (i >= BOARD_WIDTH || j >= BOARD_HEIGHT)
+        return 0;
+    return m_cellPlayers[i][j];
+}
+
+int StudentWorld::getWinner() const
+{
+    return m_winner;
 }
 
 int StudentWorld::getBank() const
@@ -270,43 +385,457 @@ int StudentWorld::getBank() const
 
 void StudentWorld::changeBank(int coins)
 {
+    uint64_t change = stateKey(hash_bank, 0, m_bank) ^ stateKey(hash_bank, 0, m_bank + coins);
+    m_boardHash ^= change;
+    m_stateHash ^= change;
     m_bank += coins;
-    cerr << m_bank << endl;
+    worldLog(m_bank, "\n");
 }
 
 void StudentWorld::depositDropping(int dropX, int dropY)
 {
-    list<Actor*>::iterator p = m_actorContainer.begin();
-    while (p != m_actorContainer.end())
+    // The dropping replaces whatever square was there, keeping its slot
+    int index = squareAt(dropX, dropY);
+    if (index < 0)
+        return;
+    Square& square = m_squares[index];
+    int cell = cellAt(dropX, dropY);
+    uint64_t change = stateKey(hash_square, cell, square.kind) ^ stateKey(hash_square, cell, dropping_square);
+    m_boardHash ^= change;
+    m_stateHash ^= change;
+    square.kind = dropping_square;
+    square.activated = 0;
+    delete m_squareSprites[index];
+    m_squareSprites[index] = new GraphObject(squareImageID(square), dropX, dropY, GraphObject::right, 1);
+}
+
+void StudentWorld::shootVortex(int vortexX, int vortexY, int dir)
+{
+    // Vortices hit whatever they overlap, so coasting movers must be where
+    // they really are while one flies
+    m_vorticesInFlight++;
+    wakeCoastingMovers();
+    Metrics::add(metric_vortex_shots);
+    
+    if (m_vortexPool.empty())
     {
-        // If a square's coordinates match arguments, delete it
-        if ((*p)->isSquare() && (*p)->getX() == dropX && (*p)->getY() == dropY)
-            {
-                delete *p;
-                m_actorContainer.erase(p);
-                break;
-            }
-        p++;
+        addActor(new Vortex(this, vortexX, vortexY, dir), metric_vortices_alive);
+        return;
     }
-    m_actorContainer.push_front(new DroppingSquare(this, dropX, dropY));
+    Vortex* vortex = m_vortexPool.back();
+    m_vortexPool.pop_back();
+    vortex->relaunch(vortexX, vortexY, dir);
+    Metrics::add(metric_vortex_reuses);
+    addActor(vortex, metric_vortices_alive);
 }
 
-void StudentWorld::shootVortex(int vortexX, int vortexY, int dir)
+void StudentWorld::buryActor(Actor* actor)
+{
+    m_graveyard.push_back(actor);
+}
+
+void StudentWorld::addActor(Actor* actor, MetricId aliveMetric)
+{
+    actor->m_aliveMetric = aliveMetric;
+    Metrics::add(aliveMetric);
+    m_stateHash ^= actor->m_stateHash;
+    actor->m_actorSlot = static_cast<int>(m_actorContainer.size());
+    m_actorContainer.push_back(actor);
+    m_awake.push_back(actor);
+    m_awakeUnsorted = true;
+}
+
+// Drops this tick's dead actors from the actor list, filling each hole with
+// the last actor, and pools or deletes them.  Only vortices die, and they
+// never sleep, so no timer is left pointing at a reclaimed actor.
+void StudentWorld::reclaimDead()
+{
+    for (Actor* actor : m_graveyard)
+    {
+        vector<Actor*>::iterator awake = find(m_awake.begin(), m_awake.end(), actor);
+        if (awake != m_awake.end())
+            m_awake.erase(awake);
+        m_awakeUnsorted = true;
+
+        int slot = actor->m_actorSlot;
+        Actor* last = m_actorContainer.back();
+        m_actorContainer[slot] = last;
+        last->m_actorSlot = slot;
+        m_actorContainer.pop_back();
+        actor->m_actorSlot = -1;
+        m_stateHash ^= actor->m_stateHash;
+        Metrics::add(static_cast<MetricId>(actor->m_aliveMetric), -1);
+        
+        if (actor->retire())
+        {
+            m_vortexPool.push_back(static_cast<Vortex*>(actor));
+            m_vorticesInFlight--;
+        }
+        else
+            delete actor;
+        worldLog("Deleted object\n");
+    }
+    m_graveyard.clear();
+}
+
+// A coasting actor is leaving its cell, so it doesn't watch it
+void StudentWorld::sleepActor(Actor* actor, int idleTicks, bool coasting)
+{
+    actor->m_asleep = true;
+    actor->m_coastFrom = coasting ? getTickCount() : -1;
+    actor->m_wakeTick = 0;
+    if (idleTicks > 0)
+    {
+        actor->m_wakeTick = getTickCount() + idleTicks + 1;
+        m_timers.schedule(actor, actor->m_wakeTick);
+    }
+    int x = actor->getX();
+    int y = actor->getY();
+    if (actor->watchesPlayers() && !coasting && squareAt(x, y) >= 0)
+    {
+        m_cellSleepers[x / SPRITE_WIDTH][y / SPRITE_HEIGHT].push_back(actor);
+        actor->m_sleepCell = (y / SPRITE_HEIGHT) * BOARD_WIDTH + x / SPRITE_WIDTH;
+    }
+}
+
+void StudentWorld::setMacroStepping(bool on)
+{
+    m_macroStepping = on;
+}
+
+bool StudentWorld::vortexInFlight() const
+{
+    return m_vorticesInFlight > 0;
+}
+
+long long StudentWorld::getActorUpdates() const
+{
+    return m_actorUpdates;
+}
+
+long long StudentWorld::skipQuietTicks(long long limit)
 {
-    m_actorContainer.push_front(new Vortex(this, vortexX, vortexY, dir));
+    long long endTick = countdownEndTick();
+    if (!m_awake.empty() || endTick < 0)
+        return 0;
+    
+    // Players with input waiting or that have just changed cells would wake
+    // someone next tick
+    for (Player* player : m_players)
+    {
+        int playerNum = player->getPlayerNum();
+        if (player->m_coastFrom < 0 && hasPendingAction(playerNum))
+            return 0;
+        if (m_playerCell[playerNum - 1] != cellAt(player->getX(), player->getY()))
+            return 0;
+    }
+    
+    long long next = min(limit, endTick);
+    long long timer = m_timers.nextExpiry();
+    if (timer >= 0)
+        next = min(next, timer);
+    long long numTicks = next - 1 - getTickCount();
+    if (numTicks <= 0)
+        return 0;
+    
+    // Nothing is due in between, but the wheel still turns one tick at a time
+    for (long long i = 0; i < numTicks; i++)
+    {
+        skipTicks(1);
+        m_timers.advance(getTickCount(), m_due);
+    }
+    m_due.clear();
+    Metrics::add(metric_ticks, numTicks);
+    return numTicks;
+}
+
+void StudentWorld::getWorldState(WorldState& state) const
+{
+    state.tick = getTickCount();
+    state.hash = m_stateHash;
+    state.board = m_boardHash;
+    state.actors.clear();
+    vector<const Actor*> actors(m_actorContainer.begin(), m_actorContainer.end());
+    sort(actors.begin(), actors.end(),
+         [](const Actor* a, const Actor* b) { return a->getActorID() < b->getActorID(); });
+    for (const Actor* actor : actors)
+    {
+        ActorState actorState;
+        const Player* player = dynamic_cast<const Player*>(actor);
+        actorState.name = actor->typeName() + to_string(player ? player->getPlayerNum() : actor->getActorID());
+        actorState.x = actor->getX();
+        actorState.y = actor->getY();
+        actorState.coins = player ? player->getCoins() : -1;
+        actorState.stars = player ? player->getStars() : -1;
+        actorState.hash = actor->getStateHash();
+        state.actors.push_back(actorState);
+    }
+}
+
+int StudentWorld::newActorID()
+{
+    return m_nextActorID++;
+}
+
+void StudentWorld::wakeCoastingMovers()
+{
+    for (Actor* actor : m_actorContainer)
+        if (actor->m_coastFrom >= 0)
+            wakeActor(actor);
+}
+
+// Woken between actors' turns, a coasting mover has also taken this tick's step
+void StudentWorld::wakeActor(Actor* actor)
+{
+    wakeActor(actor, getTickCount());
+}
+
+void StudentWorld::wakeActor(Actor* actor, long long walkedThrough)
+{
+    if (!actor->m_asleep)
+        return;
+    actor->m_asleep = false;
+    if (actor->m_coastFrom >= 0)
+    {
+        actor->coast(static_cast<int>(walkedThrough - actor->m_coastFrom));
+        actor->m_coastFrom = -1;
+    }
+    if (actor->m_sleepCell >= 0)
+    {
+        vector<Actor*>& sleepers = m_cellSleepers[actor->m_sleepCell % BOARD_WIDTH][actor->m_sleepCell / BOARD_WIDTH];
+        sleepers.erase(find(sleepers.begin(), sleepers.end(), actor));
+        actor->m_sleepCell = -1;
+    }
+    m_awake.push_back(actor);
+    m_awakeUnsorted = true;
+}
+
+// Wakes the actors whose timers run out this tick and the players with
+// input waiting
+void StudentWorld::wakeDueActors()
+{
+    m_due.clear();
+    m_timers.advance(getTickCount(), m_due);
+    for (Actor* actor : m_due)
+    {
+        // Actors woken early ignore their old timers.  Coasting movers have
+        // arrived at the square they act on this tick.
+        if (actor->m_asleep && actor->m_wakeTick == getTickCount())
+            wakeActor(actor, getTickCount() - 1);
+    }
+    for (Player* player : m_players)
+    {
+        // Coasting players only read input once they reach the square
+        if (player->m_asleep && player->m_coastFrom < 0 && hasPendingAction(player->getPlayerNum()))
+            wakeActor(player);
+    }
+}
+
+void StudentWorld::wakeCell(int cell)
+{
+    vector<Actor*>& sleepers = m_cellSleepers[cell % BOARD_WIDTH][cell / BOARD_WIDTH];
+    while (!sleepers.empty())
+        wakeActor(sleepers.back());
 }
 
 bool StudentWorld::checkVortexOverlap(Vortex* vortex)
 {
-    list<Actor*>::iterator p = m_actorContainer.begin();
-    while (p != m_actorContainer.end())
+    for (Actor* actor : m_actorContainer)
     {
-        if ((*p)->canGetHitByVortex() && (*p)->overlapsWith(vortex))
+        if (actor->canGetHitByVortex() && actor->overlapsWith(vortex))
         {
-            (*p)->hitByVortex();
+            Metrics::add(metric_vortex_hits);
+            actor->hitByVortex();
             return true;
         }
-        p++;
     }
     return false;
 }
+
+// Returns the board cell at pixel coordinates (x, y) as row * BOARD_WIDTH +
+// column, or -1 if (x, y) isn't exactly on one
+int StudentWorld::cellAt(int x, int y) const
+{
+    if (x < 0 || y < 0 || x % SPRITE_WIDTH != 0 || y % SPRITE_HEIGHT != 0 ||
+        x / SPRITE_WIDTH >= BOARD_WIDTH || y / SPRITE_HEIGHT >= BOARD_HEIGHT)
+        return -1;
+    return (y / SPRITE_HEIGHT) * BOARD_WIDTH + x / SPRITE_WIDTH;
+}
+
+// Returns the index of the square at pixel coordinates (x, y), or -1
+int StudentWorld::squareAt(int x, int y) const
+{
+    if (x < 0 || y < 0 || x % SPRITE_WIDTH != 0 || y % SPRITE_HEIGHT != 0)
+        return -1;
+    int i = x / SPRITE_WIDTH;
+    int j = y / SPRITE_HEIGHT;
+    if (i >= BOARD_WIDTH || j >= BOARD_HEIGHT)
+        return -1;
+    return m_squareIndex[i][j];
+}
+
+void StudentWorld::addSquare(int kind, int i, int j, int coins, int dir)
+{
+    Square square;
+    square.kind = kind;
+    square.activated = 0;
+    square.coins = coins;
+    square.dir = dir;
+    square.x = SPRITE_WIDTH * i;
+    square.y = SPRITE_HEIGHT * j;
+    m_squareIndex[i][j] = static_cast<short>(m_squares.size());
+    m_squares.push_back(square);
+    uint64_t key = stateKey(hash_square, j * BOARD_WIDTH + i, kind);
+    m_boardHash ^= key;
+    m_stateHash ^= key;
+    m_squareSprites.push_back(new GraphObject(squareImageID(square), square.x, square.y, dir, 1));
+}
+
+// Squares only matter where a player is standing, so rather than visiting
+// every square only the ones under the players are looked up.  A square acts
+// on a player once per visit; the visit ends when the player leaves.
+void StudentWorld::activateSquares()
+{
+    for (Player* player : m_players)
+    {
+        int playerNum = player->getPlayerNum();
+        uint64_t bit = uint64_t(1) << (playerNum - 1);
+        int index = squareAt(player->getX(), player->getY());
+        int& last = m_playerSquare[playerNum - 1];
+        if (last >= 0 && last != index)
+            m_squares[last].activated &= ~bit;
+        if (m_heatmap != nullptr && index >= 0 && index != last)
+        {
+            const Square& square = m_squares[index];
+            if (player->isWalking())
+                m_heatmap->countPass(square.x / SPRITE_WIDTH, square.y / SPRITE_HEIGHT);
+            else
+                m_heatmap->countLanding(square.x / SPRITE_WIDTH, square.y / SPRITE_HEIGHT);
+        }
+        last = index;
+        if (index < 0 || (m_squares[index].activated & bit))
+            continue;
+        if (activateSquare(this, m_squares[index], player))
+            m_squares[index].activated |= bit;
+    }
+}
+
+// Records which cell, if any, each player stands exactly on, for actors
+// that only care about the players sharing their cell
+void StudentWorld::updatePlayerCells()
+{
+    for (Player* player : m_players)
+    {
+        int playerNum = player->getPlayerNum();
+        uint64_t bit = uint64_t(1) << (playerNum - 1);
+        int& cell = m_playerCell[playerNum - 1];
+        int oldCell = cell;
+        if (cell >= 0)
+            m_cellPlayers[cell % BOARD_WIDTH][cell / BOARD_WIDTH] &= ~bit;
+        cell = cellAt(player->getX(), player->getY());
+        if (cell >= 0)
+            m_cellPlayers[cell % BOARD_WIDTH][cell / BOARD_WIDTH] |= bit;
+        
+        // Sleeping enemies notice players coming and going
+        if (cell != oldCell)
+        {
+            if (oldCell >= 0)
+                wakeCell(oldCell);
+            if (cell >= 0)
+                wakeCell(cell);
+        }
+    }
+}
+
+void StudentWorld::updateStatusText()
+{
+    // The status line shows the first two players
+    Player* peach = getPlayer(1);
+    Player* yoshi = getPlayer(2);
+
+    // Determine if Peach and Yoshi have vortexes
+    string peachVortex = "";
+    if (peach->hasVortex())
+        peachVortex = " VOR";
+    string yoshiVortex = "";
+    if (yoshi->hasVortex())
+        yoshiVortex = " VOR";
+    
+    // Update text
+    ostringstream oss;
+    oss << "P1 Roll: " << peach->squaresToMove() << " Stars: " << peach->getStars() << " $$: " << peach->getCoins() << peachVortex << " | Time: " << timeRemaining() << " | Bank: " << m_bank << " | P2 Roll: " << yoshi->squaresToMove() << " Stars: " << yoshi->getStars() << " $$: " << yoshi->getCoins() << yoshiVortex;
+    string text = oss.str();
+    setGameStatText(text);
+}
+
+// Everything this world draws, back to front, for renderers that don't use
+// the GraphObject display lists
+void StudentWorld::getSprites(vector<GraphObject*>& sprites) const
+{
+    sprites.assign(m_squareSprites.begin(), m_squareSprites.end());
+    sprites.insert(sprites.end(), m_actorContainer.begin(), m_actorContainer.end());
+}
+
+void StudentWorld::setHeatmap(SquareHeatmap* heatmap)
+{
+    m_heatmap = heatmap;
+}
+
+void StudentWorld::setEconomyLog(EconomyLog* log)
+{
+    m_economyLog = log;
+}
+
+void StudentWorld::recordEconomy(int kind, const Player* player, int x, int y, int coins, int stars, int bank,
+                                 const Player* otherPlayer)
+{
+    EconomyEvent event;
+    event.tick = static_cast<uint32_t>(getTickCount());
+    event.kind = static_cast<uint8_t>(kind);
+    event.player = static_cast<uint8_t>(player->getPlayerNum());
+    event.otherPlayer = static_cast<uint8_t>(otherPlayer != nullptr ? otherPlayer->getPlayerNum() : 0);
+    event.cell = static_cast<uint8_t>((y / SPRITE_HEIGHT) * BOARD_WIDTH + x / SPRITE_WIDTH);
+    event.coins = coins;
+    event.stars = stars;
+    event.bank = bank;
+    event.coinsAfter = player->getCoins();
+    event.starsAfter = player->getStars();
+    event.bankAfter = m_bank;
+    m_economyLog->add(event);
+}
+
+void StudentWorld::setBoard(const Board* board)
+{
+    m_presetBoard = board;
+}
+
+void StudentWorld::setHeatmapOverlay(bool show)
+{
+    m_heatmapOverlay = show;
+    if (show && m_heatmap == nullptr)
+    {
+        m_overlayHeatmap.clear();
+        m_heatmap = &m_overlayHeatmap;
+    }
+    if (show)
+        tintSquares();
+    else
+    {
+        for (GraphObject* sprite : m_squareSprites)
+            sprite->setBrightness(1.0);
+    }
+}
+
+// Dims each square by how rarely it is visited, so busy squares stand out
+void StudentWorld::tintSquares()
+{
+    unsigned int most = m_heatmap->maxVisits();
+    for (size_t i = 0; i < m_squares.size(); i++)
+    {
+        int cellX = m_squares[i].x / SPRITE_WIDTH;
+        int cellY = m_squares[i].y / SPRITE_HEIGHT;
+        unsigned int visits = m_heatmap->passes(cellX, cellY) + m_heatmap->landings(cellX, cellY);
+        double heat = (most == 0) ? 0 : static_cast<double>(visits) / most;
+        m_squareSprites[i]->setBrightness(0.2 + 0.8 * heat);
+    }
+}
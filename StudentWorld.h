@@ -3,12 +3,15 @@
 
 #include "GameWorld.h"
 #include "Board.h"
+#include "Actor.h"
+#include "MoverStore.h"
+#include "Heatmap.h"
+#include "EconomyLog.h"
+#include "TimerWheel.h"
+#include "Metrics.h"
+#include "StateHash.h"
 #include <string>
-#include <list>
-
-class Actor;
-class Player;
-class Vortex;
+#include <vector>
 
 class StudentWorld : public GameWorld
 {
@@ -18,13 +21,49 @@ public:
     virtual int init();
     virtual int move();
     virtual void cleanUp();
+    virtual void setHeatmapOverlay(bool show);
+    
+    bool squareHasCoordinates(int x, int y) const;
+    void chooseRandomSquare(int& x, int& y);
+    const std::vector<Square>& getSquares() const;
+    MoverStore& getMovers();
+    void getSprites(std::vector<GraphObject*>& sprites) const;
     
-    bool squareHasCoordinates(int x, int y);
-    Actor* chooseRandomSquare();
+    // Counts passes, landings and square effects into heatmap (nullptr to stop)
+    void setHeatmap(SquareHeatmap* heatmap);
+    // Plays on board (e.g. a generated one) instead of loading the board
+    // number's file; nullptr to load files again
+    void setBoard(const Board* board);
+    void countHeat(HeatEvent event, int x, int y)
+    {
+        m_eventCounts[event]++;
+        if (m_heatmap != nullptr)
+            m_heatmap->countEvent(event, x / SPRITE_WIDTH, y / SPRITE_HEIGHT);
+    }
+    // Appends every coin, star and bank transaction to log (nullptr to stop)
+    void setEconomyLog(EconomyLog* log);
+    // Records a transaction at pixel (x, y) if there is a log; the changes
+    // are those actually applied to player (see EconomyLog.h)
+    void logEconomy(int kind, const Player* player, int x, int y, int coins, int stars = 0, int bank = 0,
+                    const Player* otherPlayer = nullptr)
+    {
+        if (m_economyLog != nullptr)
+            recordEconomy(kind, player, x, y, coins, stars, bank, otherPlayer);
+    }
+    // Times event has happened this game, heatmap or not
+    unsigned int getEventCount(HeatEvent event) const
+    {
+        return m_eventCounts[event];
+    }
     
-    Player* getPeach() const;
-    Player* getYoshi() const;
+    // Players are numbered from 1; Peach is 1 and Yoshi is 2
+    Player* getPlayer(int playerNum) const;
+    // The opponent in a two-player game, otherwise a random other player
     Player* getOtherPlayer(Player* player) const;
+    // Bit n set for each player n+1 standing exactly at (x, y), as of the
+    // start of this tick
+    uint64_t getPlayersAt(int x, int y) const;
+    int getWinner() const;
     
     int getBank() const;
     void changeBank(int coins);
@@ -33,11 +72,96 @@ public:
 
     void shootVortex(int vortexX, int vortexY, int dir);
     bool checkVortexOverlap(Vortex* vortex);
+    
+    // Queues a newly dead actor to be reclaimed at the end of the tick
+    void buryActor(Actor* actor);
+    // Has a sleeping actor act again from the next tick on
+    void wakeActor(Actor* actor);
+    
+    // Headless runs may let movers walk a whole square in one update rather
+    // than 2 pixels a tick; play is otherwise identical.  Off by default
+    // because the positions of walking movers are only exact at squares.
+    void setMacroStepping(bool on);
+    bool vortexInFlight() const;
+    // doSomething() calls made so far
+    long long getActorUpdates() const;
+    // Brings movers coasting between squares to where they really are; call
+    // before reading positions from outside move()
+    void wakeCoastingMovers();
+    
+    // The Zobrist hash of the actors in play, the squares and the bank (see
+    // StateHash.h), kept up to date as they change.  Like positions, it is
+    // only exact after wakeCoastingMovers().
+    uint64_t getStateHash() const
+    {
+        return m_stateHash;
+    }
+    // The hash with each actor's share, in actor ID order
+    void getWorldState(WorldState& state) const;
+    // For actors: changes to their share of the hash while in play
+    void changeStateHash(uint64_t change)
+    {
+        m_stateHash ^= change;
+    }
+    int newActorID();
+    
+    // Call between moves: if no actor would act on the next tick, jumps the
+    // clock ahead to just before the next tick when something happens (a
+    // timer expiring or the game ending), but no further than the tick
+    // before limit, and returns the number of ticks skipped.  The caller
+    // must know that no input will arrive before limit.
+    long long skipQuietTicks(long long limit);
 private:
-    std::list<Actor*> m_actorContainer;
-    Player* m_peach;
-    Player* m_yoshi;
+    std::vector<Actor*> m_actorContainer;
+    std::vector<Actor*> m_graveyard;                 // died this tick
+    std::vector<Vortex*> m_vortexPool;               // retired, ready to fire again
+    std::vector<Actor*> m_awake;                     // actors that act each tick
+    bool m_awakeUnsorted;                            // not in actor list order
+    TimerWheel m_timers;
+    bool m_macroStepping;
+    int m_vorticesInFlight;
+    long long m_actorUpdates;
+    int m_movesSinceTimed;
+    static const int MOVE_SAMPLE_INTERVAL = 64;
+    std::vector<Actor*> m_due;
+    std::vector<Actor*> m_cellSleepers[BOARD_WIDTH][BOARD_HEIGHT];
+    MoverStore m_movers;
+    std::vector<Square> m_squares;
+    std::vector<GraphObject*> m_squareSprites;      // parallel to m_squares
+    short m_squareIndex[BOARD_WIDTH][BOARD_HEIGHT];  // -1 where there is no square
+    std::vector<Player*> m_players;                 // indexed by player number - 1
+    std::vector<int> m_playerSquare;                 // square each player was last on, or -1
+    std::vector<int> m_playerCell;                   // cell each player is counted in, or -1
+    uint64_t m_cellPlayers[BOARD_WIDTH][BOARD_HEIGHT];
+    int m_winner;
     int m_bank;
+    uint64_t m_stateHash;
+    uint64_t m_boardHash;                            // squares and the bank
+    int m_nextActorID;
+    SquareHeatmap* m_heatmap;
+    unsigned int m_eventCounts[NUM_HEAT_EVENTS];
+    EconomyLog* m_economyLog;
+    const Board* m_presetBoard;
+    SquareHeatmap m_overlayHeatmap;   // used by the overlay when no heatmap was given
+    bool m_heatmapOverlay;
+    
+    // aliveMetric counts the actor's type while it's in play
+    void addActor(Actor* actor, MetricId aliveMetric);
+    void reclaimDead();
+    void sleepActor(Actor* actor, int idleTicks, bool coasting = false);
+    void wakeDueActors();
+    void wakeActor(Actor* actor, long long walkedThrough);
+    void wakeCell(int cell);
+    int squareAt(int x, int y) const;
+    int cellAt(int x, int y) const;
+    void addSquare(int kind, int i, int j, int coins = 0, int dir = GraphObject::right);
+    void activateSquares();
+    void updatePlayerCells();
+    void updateStatusText();
+    void tintSquares();
+    int playTick();
+    void recordEconomy(int kind, const Player* player, int x, int y, int coins, int stars, int bank,
+                       const Player* otherPlayer);
 };
 
 #endif // STUDENTWORLD_H_
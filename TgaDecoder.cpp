@@ -0,0 +1,285 @@
+#include "TgaDecoder.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TGA_SSSE3
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define TGA_NEON
+#include <arm_neon.h>
+#endif
+using namespace std;
+
+namespace
+{
+    const size_t HEADER_SIZE = 18;
+
+    // TGA stores color pixels as BGR or BGRA.  The scalar versions also
+    // finish the few pixels at the end of a row the vector loops leave.
+
+    void bgraToRgba(const unsigned char* src, unsigned char* dst, int numPixels)
+    {
+        for (int i = 0; i < numPixels; i++, src += 4, dst += 4)
+        {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            dst[3] = src[3];
+        }
+    }
+
+    void bgrToRgba(const unsigned char* src, unsigned char* dst, int numPixels)
+    {
+        for (int i = 0; i < numPixels; i++, src += 3, dst += 4)
+        {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            dst[3] = 255;
+        }
+    }
+
+    void greyToRgba(const unsigned char* src, unsigned char* dst, int numPixels)
+    {
+        for (int i = 0; i < numPixels; i++, src++, dst += 4)
+        {
+            dst[0] = dst[1] = dst[2] = src[0];
+            dst[3] = 255;
+        }
+    }
+
+#if defined(TGA_SSSE3)
+    // Compiled for SSSE3 whatever the build flags, and only called if the
+    // CPU has it
+
+    __attribute__((target("ssse3")))
+    void bgraToRgbaSsse3(const unsigned char* src, unsigned char* dst, int numPixels)
+    {
+        const __m128i swapRedBlue = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        int i = 0;
+        for ( ; i + 4 <= numPixels; i += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_shuffle_epi8(pixels, swapRedBlue));
+        }
+        bgraToRgba(src + i * 4, dst + i * 4, numPixels - i);
+    }
+
+    __attribute__((target("ssse3")))
+    void bgrToRgbaSsse3(const unsigned char* src, unsigned char* dst, int numPixels)
+    {
+        // Spreads 4 pixels' 12 bytes over 16, zeroing the alpha bytes, which
+        // are then set opaque
+        const __m128i spread = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+        const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        int i = 0;
+        // Each load reads 16 bytes to use 12, so stop while a load would
+        // run off the end of the row
+        for ( ; i + 6 <= numPixels; i += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+            pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, spread), opaque);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), pixels);
+        }
+        bgrToRgba(src + i * 3, dst + i * 4, numPixels - i);
+    }
+
+    bool hasSsse3()
+    {
+        static const bool has = __builtin_cpu_supports("ssse3");
+        return has;
+    }
+#elif defined(TGA_NEON)
+    void bgraToRgbaNeon(const unsigned char* src, unsigned char* dst, int numPixels)
+    {
+        int i = 0;
+        for ( ; i + 16 <= numPixels; i += 16)
+        {
+            uint8x16x4_t pixels = vld4q_u8(src + i * 4);
+            uint8x16_t blue = pixels.val[0];
+            pixels.val[0] = pixels.val[2];
+            pixels.val[2] = blue;
+            vst4q_u8(dst + i * 4, pixels);
+        }
+        bgraToRgba(src + i * 4, dst + i * 4, numPixels - i);
+    }
+
+    void bgrToRgbaNeon(const unsigned char* src, unsigned char* dst, int numPixels)
+    {
+        int i = 0;
+        for ( ; i + 16 <= numPixels; i += 16)
+        {
+            uint8x16x3_t pixels = vld3q_u8(src + i * 3);
+            uint8x16x4_t out;
+            out.val[0] = pixels.val[2];
+            out.val[1] = pixels.val[1];
+            out.val[2] = pixels.val[0];
+            out.val[3] = vdupq_n_u8(255);
+            vst4q_u8(dst + i * 4, out);
+        }
+        bgrToRgba(src + i * 3, dst + i * 4, numPixels - i);
+    }
+#endif
+
+    typedef void (*RowConverter)(const unsigned char* src, unsigned char* dst, int numPixels);
+
+    RowConverter converterFor(int bytesPerPixel)
+    {
+        switch (bytesPerPixel)
+        {
+            case 1:
+                return greyToRgba;
+            case 3:
+#if defined(TGA_SSSE3)
+                if (hasSsse3())
+                    return bgrToRgbaSsse3;
+#elif defined(TGA_NEON)
+                return bgrToRgbaNeon;
+#endif
+                return bgrToRgba;
+            default:
+#if defined(TGA_SSSE3)
+                if (hasSsse3())
+                    return bgraToRgbaSsse3;
+#elif defined(TGA_NEON)
+                return bgraToRgbaNeon;
+#endif
+                return bgraToRgba;
+        }
+    }
+}
+
+bool decodeTga(const unsigned char* data, size_t size, TgaImage& image, string& error)
+{
+    if (size < HEADER_SIZE)
+    {
+        error = "Truncated TGA header";
+        return false;
+    }
+    int idLength = data[0];
+    int colorMapType = data[1];
+    int imageType = data[2];
+    int width = data[12] | (data[13] << 8);
+    int height = data[14] | (data[15] << 8);
+    int bitsPerPixel = data[16];
+    int descriptor = data[17];
+
+    // Types 2 (color) and 3 (greyscale), or 10 and 11 for their RLE forms
+    bool runLength = (imageType == 10 || imageType == 11);
+    int baseType = runLength ? imageType - 8 : imageType;
+    int bytesPerPixel = bitsPerPixel / 8;
+    if (colorMapType != 0 || (baseType != 2 && baseType != 3))
+    {
+        error = "Unsupported TGA image type " + to_string(imageType);
+        return false;
+    }
+    if (bitsPerPixel % 8 != 0 || (bytesPerPixel != 3 && bytesPerPixel != 4 &&
+                                  !(bytesPerPixel == 1 && baseType == 3)))
+    {
+        error = "Unsupported TGA pixel depth " + to_string(bitsPerPixel);
+        return false;
+    }
+
+    image.width = width;
+    image.height = height;
+    image.rgba.resize(static_cast<size_t>(width) * height * 4);
+    if (image.rgba.empty())
+        return true;
+    RowConverter convert = converterFor(bytesPerPixel);
+    bool topFirst = (descriptor & 0x20) != 0;
+    size_t rowBytes = static_cast<size_t>(width) * bytesPerPixel;
+    auto destinationRow = [&](int row)
+    {
+        return &image.rgba[static_cast<size_t>(topFirst ? height - 1 - row : row) * width * 4];
+    };
+
+    size_t pos = HEADER_SIZE + idLength;
+    if (!runLength)
+    {
+        if (pos > size || size - pos < rowBytes * height)
+        {
+            error = "Truncated TGA pixel data";
+            return false;
+        }
+        for (int row = 0; row < height; row++, pos += rowBytes)
+            convert(data + pos, destinationRow(row), width);
+        return true;
+    }
+
+    // Each packet is a header byte and then either one pixel repeated
+    // (high bit set) or up to 128 literal pixels.  Packets may run on from
+    // one row to the next, so a row is gathered before being converted.
+    vector<unsigned char> rowPixels(rowBytes);
+    int packetLeft = 0;
+    bool repeated = false;
+    const unsigned char* repeatedPixel = nullptr;
+    for (int row = 0; row < height; row++)
+    {
+        unsigned char* out = rowPixels.data();
+        for (int x = 0; x < width; )
+        {
+            if (packetLeft == 0)
+            {
+                if (pos >= size)
+                {
+                    error = "Truncated TGA run-length data";
+                    return false;
+                }
+                int packet = data[pos++];
+                packetLeft = (packet & 0x7F) + 1;
+                repeated = (packet & 0x80) != 0;
+                if (repeated)
+                {
+                    if (size - pos < static_cast<size_t>(bytesPerPixel))
+                    {
+                        error = "Truncated TGA run-length data";
+                        return false;
+                    }
+                    repeatedPixel = data + pos;
+                    pos += bytesPerPixel;
+                }
+            }
+            int count = min(packetLeft, width - x);
+            size_t bytes = static_cast<size_t>(count) * bytesPerPixel;
+            if (repeated)
+            {
+                for (int i = 0; i < count; i++, out += bytesPerPixel)
+                    memcpy(out, repeatedPixel, bytesPerPixel);
+            }
+            else
+            {
+                if (size - pos < bytes)
+                {
+                    error = "Truncated TGA run-length data";
+                    return false;
+                }
+                memcpy(out, data + pos, bytes);
+                pos += bytes;
+                out += bytes;
+            }
+            x += count;
+            packetLeft -= count;
+        }
+        convert(rowPixels.data(), destinationRow(row), width);
+    }
+    return true;
+}
+
+bool loadTga(const string& filename, TgaImage& image)
+{
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        cerr << "***** Unable to open " << filename << endl;
+        return false;
+    }
+    string error;
+    if (!decodeTga(file.data(), file.size(), image, error))
+    {
+        cerr << "***** " << error << " in " << filename << endl;
+        return false;
+    }
+    return true;
+}
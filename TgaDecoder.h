@@ -0,0 +1,29 @@
+#ifndef TGADECODER_H_
+#define TGADECODER_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// A decoded sprite: RGBA, 4 bytes per pixel, bottom row first (the order
+// OpenGL textures and the software renderer both use)
+struct TgaImage
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> rgba;
+};
+
+// Decodes true-color and greyscale TGA images, uncompressed (types 2 and 3)
+// or run-length encoded (types 10 and 11), at 8, 24 or 32 bits per pixel.
+// Pixels are converted to RGBA a row at a time with SSSE3 or NEON where the
+// CPU has it, and written straight to their flipped row, so top-first images
+// cost nothing extra.  Color-mapped images are not supported.
+
+// Decodes the image held in data; on failure, error says why
+bool decodeTga(const unsigned char* data, size_t size, TgaImage& image, std::string& error);
+
+// Maps filename and decodes it, reporting failures on cerr
+bool loadTga(const std::string& filename, TgaImage& image);
+
+#endif // TGADECODER_H_
@@ -0,0 +1,88 @@
+#include "TimerWheel.h"
+#include <algorithm>
+using namespace std;
+
+TimerWheel::TimerWheel()
+{
+    m_now = 0;
+}
+
+void TimerWheel::reset(long long now)
+{
+    for (vector<Timer>& slot : m_fine)
+        slot.clear();
+    for (vector<Timer>& slot : m_coarse)
+        slot.clear();
+    m_far.clear();
+    m_now = now;
+}
+
+void TimerWheel::schedule(Actor* actor, long long tick)
+{
+    place(Timer{ actor, tick });
+}
+
+void TimerWheel::place(const Timer& timer)
+{
+    if (timer.tick - m_now < FINE_SLOTS)
+        m_fine[timer.tick & (FINE_SLOTS - 1)].push_back(timer);
+    else if ((timer.tick >> FINE_BITS) - (m_now >> FINE_BITS) < COARSE_SLOTS)
+        m_coarse[(timer.tick >> FINE_BITS) % COARSE_SLOTS].push_back(timer);
+    else
+        m_far.push_back(timer);
+}
+
+long long TimerWheel::nextExpiry() const
+{
+    for (int i = 1; i < FINE_SLOTS; i++)
+    {
+        if (!m_fine[(m_now + i) & (FINE_SLOTS - 1)].empty())
+            return m_now + i;
+    }
+    long long block = m_now >> FINE_BITS;
+    for (int i = 1; i < COARSE_SLOTS; i++)
+    {
+        const vector<Timer>& coarse = m_coarse[(block + i) % COARSE_SLOTS];
+        if (coarse.empty())
+            continue;
+        long long earliest = coarse[0].tick;
+        for (const Timer& timer : coarse)
+            earliest = min(earliest, timer.tick);
+        return earliest;
+    }
+    long long earliest = -1;
+    for (const Timer& timer : m_far)
+    {
+        if (earliest < 0 || timer.tick < earliest)
+            earliest = timer.tick;
+    }
+    return earliest;
+}
+
+void TimerWheel::advance(long long tick, vector<Actor*>& due)
+{
+    m_now = tick;
+    
+    // At the start of each 256-tick block, spread its coarse slot over the
+    // fine wheel, and once per turn of the coarse wheel recheck the far timers
+    if ((tick & (FINE_SLOTS - 1)) == 0)
+    {
+        long long block = tick >> FINE_BITS;
+        if (block % COARSE_SLOTS == 0)
+        {
+            vector<Timer> far;
+            far.swap(m_far);
+            for (const Timer& timer : far)
+                place(timer);
+        }
+        vector<Timer>& coarse = m_coarse[block % COARSE_SLOTS];
+        for (const Timer& timer : coarse)
+            place(timer);
+        coarse.clear();
+    }
+    
+    vector<Timer>& fine = m_fine[tick & (FINE_SLOTS - 1)];
+    for (const Timer& timer : fine)
+        due.push_back(timer.actor);
+    fine.clear();
+}
@@ -0,0 +1,47 @@
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <vector>
+
+class Actor;
+
+// Wakes sleeping actors at the tick they asked for.  Timers due within 256
+// ticks go straight into a slot per tick; later ones wait in a coarser wheel
+// of 256-tick slots and drop into the fine one as their turn comes, so
+// scheduling and expiry cost O(1) however many actors are asleep.
+//
+// Timers can't be cancelled: an actor woken early just ignores its timer
+// when it expires.
+class TimerWheel
+{
+public:
+    TimerWheel();
+    // Forgets every timer and starts counting from tick now
+    void reset(long long now);
+    // tick must be later than the last tick advanced to
+    void schedule(Actor* actor, long long tick);
+    // Moves on to tick, which must be the next one, and appends the actors
+    // whose timers expire there
+    void advance(long long tick, std::vector<Actor*>& due);
+    // The earliest tick a timer expires, or -1 if there are none
+    long long nextExpiry() const;
+private:
+    struct Timer
+    {
+        Actor* actor;
+        long long tick;
+    };
+    
+    static const int FINE_BITS = 8;
+    static const int FINE_SLOTS = 1 << FINE_BITS;
+    static const int COARSE_SLOTS = 64;
+    
+    std::vector<Timer> m_fine[FINE_SLOTS];
+    std::vector<Timer> m_coarse[COARSE_SLOTS];
+    std::vector<Timer> m_far;          // beyond the coarse wheel
+    long long m_now;
+    
+    void place(const Timer& timer);
+};
+
+#endif // TIMERWHEEL_H_
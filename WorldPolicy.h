@@ -0,0 +1,57 @@
+#ifndef WORLDPOLICY_H_
+#define WORLDPOLICY_H_
+
+#include <random>
+#include <iostream>
+
+  // Features of the world that a build may leave out.  The game is built
+  // with InteractivePolicy.  The headless tools are built with PEACH_HEADLESS
+  // and get HeadlessPolicy, whose disabled features are constant-false
+  // branches that the compiler removes from the tick code entirely.
+
+struct InteractivePolicy
+{
+	static constexpr bool logging = true;          // trace game events to cerr
+	static constexpr bool hud = true;              // rebuild the status line every tick
+	static constexpr bool registerSprites = true;  // GraphObjects join the display lists
+
+	static std::default_random_engine& rng()
+	{
+		static std::random_device rd;
+		static std::default_random_engine generator(rd());
+		return generator;
+	}
+};
+
+struct HeadlessPolicy
+{
+	static constexpr bool logging = false;
+	static constexpr bool hud = false;
+	static constexpr bool registerSprites = false;
+
+	  // One engine per thread, so that worker threads can each play games
+	  // reproducibly
+	static std::default_random_engine& rng()
+	{
+		thread_local std::default_random_engine generator(std::random_device{}());
+		return generator;
+	}
+};
+
+#ifdef PEACH_HEADLESS
+typedef HeadlessPolicy WorldPolicy;
+#else
+typedef InteractivePolicy WorldPolicy;
+#endif
+
+  // Writes its arguments to cerr if the policy logs; otherwise the call and
+  // the formatting of its arguments compile away
+
+template <typename... Args>
+inline void worldLog(const Args&... args)
+{
+	if (WorldPolicy::logging)
+		(std::cerr << ... << args);
+}
+
+#endif // WORLDPOLICY_H_
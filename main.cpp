@@ -1,4 +1,6 @@
 #include "GameController.h"
+#include "GameWorld.h"
+#include "AssetPack.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -24,14 +26,31 @@ bool is_directory(string path)
 
 const string assetDirectory = "Assets";
 
-class GameWorld;
-
 GameWorld* createStudentWorld(string assetPath = "");
 
 int main(int argc, char* argv[])
 {
     string assetPath = (argc > 1 ? argv[1] : assetDirectory);
-    if (!assetPath.empty())
+
+      // Use the asset pack if one is named, or if there's no argument and
+      // Assets.pak exists; it must outlive the world
+    AssetPack pack;
+    bool packNamed = (assetPath.size() > 4  &&  assetPath.compare(assetPath.size() - 4, 4, ".pak") == 0);
+    if (packNamed  ||  argc <= 1)
+    {
+        string packPath = packNamed ? assetPath : assetDirectory + ".pak";
+        if (!pack.open(packPath)  &&  packNamed)
+        {
+            cout << "Cannot open asset pack " << packPath << endl;
+            return 1;
+        }
+          // Sounds played through the platform's player still come from
+          // the directory named like the pack
+        if (pack.isOpen())
+            assetPath = packPath.substr(0, packPath.size() - 4) + "/";
+    }
+
+    if (!pack.isOpen()  &&  !assetPath.empty())
     {
         if (!is_directory(assetPath))
         {
@@ -41,6 +60,7 @@ int main(int argc, char* argv[])
         if (assetPath.back() != '/')
             assetPath.push_back('/');
     }
+    if (!pack.isOpen())
     {
         const string someAsset = "star_square.tga";
         ifstream ifs(assetPath + someAsset);
@@ -53,5 +73,7 @@ int main(int argc, char* argv[])
     }
 
     GameWorld* gw = createStudentWorld(assetPath);
+    if (pack.isOpen())
+        gw->setAssetPack(&pack);
     Game().run(argc, argv, gw, "Peach Party");
 }
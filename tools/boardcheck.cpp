@@ -0,0 +1,199 @@
+// boardcheck: validates board files in bulk, reporting where each problem is.
+//
+//   boardcheck [options] path...
+//     --jobs N           check N files at a time on worker threads (default:
+//                        one per core)
+//     --quiet            print only the boards with errors and the summary
+//     --warnings-as-errors
+//                        fail boards that only have warnings
+//     --repeat N         check everything N times, for measuring throughput
+//     --target R         fail unless at least R boards a second are checked
+//
+// Each path is a board file or a directory, whose *.txt files are checked.
+// Files are mapped into memory rather than read.  Problems are printed as
+//
+//   file:line:column: error|warning: message
+//
+// in the order the files were given, followed by a summary line with the
+// throughput.  Exits with 1 if any board has errors (or the target is
+// missed), 2 on bad arguments.
+
+#include "Board.h"
+#include "BoardCheck.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+using namespace std;
+
+static void usage()
+{
+    cerr << "usage: boardcheck [--jobs N] [--quiet] [--warnings-as-errors] [--repeat N]\n"
+         << "                  [--target BOARDS_PER_SEC] path..." << endl;
+}
+
+struct FileResult
+{
+    int errors = 0;
+    int warnings = 0;
+    string report;
+};
+
+static void checkFile(const string& path, FileResult& result)
+{
+    result = FileResult();
+    ostringstream out;
+    MappedFile file;
+    Board board;
+    if (!file.open(path))
+    {
+        out << path << ": error: cannot open file\n";
+        result.errors++;
+    }
+    else if (board.parseBoard(reinterpret_cast<const char*>(file.data()), file.size()) != Board::load_success)
+    {
+        out << path;
+        if (board.getErrorLine() > 0)
+            out << ":" << board.getErrorLine() << ":" << board.getErrorColumn();
+        out << ": error: " << board.getErrorMessage() << "\n";
+        result.errors++;
+    }
+    else
+    {
+        vector<BoardIssue> issues;
+        checkBoardLayout(board, issues);
+        for (const BoardIssue& issue : issues)
+        {
+            out << path << ":" << issue.line << ":" << issue.column << ": "
+                << (issue.error ? "error" : "warning") << ": " << issue.message << "\n";
+            if (issue.error)
+                result.errors++;
+            else
+                result.warnings++;
+        }
+    }
+    result.report = out.str();
+}
+
+// Files named directly are kept; directories contribute their *.txt files
+static bool collectFiles(const string& path, vector<string>& files)
+{
+    namespace fs = std::filesystem;
+    error_code ec;
+    if (!fs::is_directory(path, ec))
+    {
+        files.push_back(path);
+        return true;
+    }
+    vector<string> found;
+    for (fs::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (it->path().extension() == ".txt" && it->is_regular_file(ec))
+            found.push_back(it->path().string());
+    }
+    if (ec)
+    {
+        cerr << "boardcheck: cannot read directory " << path << ": " << ec.message() << endl;
+        return false;
+    }
+    sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    int jobs = static_cast<int>(thread::hardware_concurrency());
+    bool quiet = false;
+    bool warningsAsErrors = false;
+    int repeat = 1;
+    double target = 0;
+    vector<string> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--jobs" && hasValue)
+            jobs = atoi(argv[++i]);
+        else if (arg == "--quiet")
+            quiet = true;
+        else if (arg == "--warnings-as-errors")
+            warningsAsErrors = true;
+        else if (arg == "--repeat" && hasValue)
+            repeat = atoi(argv[++i]);
+        else if (arg == "--target" && hasValue)
+            target = atof(argv[++i]);
+        else if (arg.size() > 1 && arg[0] == '-')
+        {
+            usage();
+            return 2;
+        }
+        else
+            paths.push_back(arg);
+    }
+    if (paths.empty() || repeat < 1)
+    {
+        usage();
+        return 2;
+    }
+    if (jobs < 1)
+        jobs = 1;
+
+    vector<string> files;
+    for (const string& path : paths)
+        if (!collectFiles(path, files))
+            return 2;
+
+    vector<FileResult> results(files.size());
+    size_t numChecks = files.size() * repeat;
+    auto start = chrono::steady_clock::now();
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        // Repeats check into a scratch result, so no two threads share one
+        FileResult scratch;
+        for (size_t i; (i = next++) < numChecks; )
+            checkFile(files[i % files.size()], i < files.size() ? results[i] : scratch);
+    };
+    vector<thread> workers;
+    int numWorkers = static_cast<int>(min<size_t>(jobs, numChecks));
+    for (int w = 1; w < numWorkers; w++)
+        workers.emplace_back(worker);
+    worker();
+    for (thread& t : workers)
+        t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int clean = 0, withWarnings = 0, withErrors = 0;
+    for (const FileResult& result : results)
+    {
+        bool failed = result.errors > 0 || (warningsAsErrors && result.warnings > 0);
+        if (failed)
+            withErrors++;
+        else if (result.warnings > 0)
+            withWarnings++;
+        else
+            clean++;
+        if (!quiet || failed)
+            cout << result.report;
+    }
+
+    double rate = (seconds > 0) ? numChecks / seconds : 0;
+    cout << "checked " << numChecks << " board" << (numChecks == 1 ? "" : "s")
+         << " in " << seconds * 1000 << " ms (" << static_cast<long long>(rate) << " boards/s): "
+         << clean << " clean, " << withWarnings << " with warnings, " << withErrors << " with errors"
+         << endl;
+
+    bool missedTarget = (target > 0 && rate < target);
+    if (missedTarget)
+        cout << "below the target of " << target << " boards/s" << endl;
+    return (withErrors > 0 || missedTarget) ? 1 : 0;
+}
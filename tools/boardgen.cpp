@@ -0,0 +1,157 @@
+// boardgen: generates random boards in the board0N.txt format.
+//
+//   boardgen [options]
+//     --seed S           board N is generated from seed S+N-1, so any one of
+//                        them can be made again on its own (default random)
+//     --count N          number of boards (default 1)
+//     --out DIR          write DIR/boardN.txt for each board; without it the
+//                        one board is printed
+//     --bench            generate the boards without writing them and report
+//                        how many were made a second
+//     --jobs N           generate on N worker threads (default 1); the boards
+//                        are the same
+//     --paths F          chance each stretch of the grid of paths is laid (0.7)
+//     --red F, --stars F, --banks F, --events F, --arrows F
+//                        fraction of the squares of each kind
+//                        (0.06, 0.03, 0.02, 0.08, 0.03)
+//     --bowsers N, --boos N
+//                        enemies on the board (1, 2)
+//
+// Every board passes boardcheck without warnings.  peachsim --random-boards
+// plays games on boards made the same way without writing them out.
+
+#include "BoardGenerator.h"
+#include "Board.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+using namespace std;
+
+static void usage()
+{
+    cerr << "usage: boardgen [--seed S] [--count N] [--out DIR] [--bench] [--jobs N] [--paths F]\n"
+         << "                [--red F] [--stars F] [--banks F] [--events F] [--arrows F]\n"
+         << "                [--bowsers N] [--boos N]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = random_device()();
+    int count = 1;
+    string outDir;
+    bool bench = false;
+    int jobs = 1;
+    BoardRecipe recipe;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--seed" && hasValue)
+            seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--count" && hasValue)
+            count = atoi(argv[++i]);
+        else if (arg == "--out" && hasValue)
+            outDir = argv[++i];
+        else if (arg == "--bench")
+            bench = true;
+        else if (arg == "--jobs" && hasValue)
+            jobs = atoi(argv[++i]);
+        else if (arg == "--paths" && hasValue)
+            recipe.paths = atof(argv[++i]);
+        else if (arg == "--red" && hasValue)
+            recipe.redCoins = atof(argv[++i]);
+        else if (arg == "--stars" && hasValue)
+            recipe.stars = atof(argv[++i]);
+        else if (arg == "--banks" && hasValue)
+            recipe.banks = atof(argv[++i]);
+        else if (arg == "--events" && hasValue)
+            recipe.events = atof(argv[++i]);
+        else if (arg == "--arrows" && hasValue)
+            recipe.arrows = atof(argv[++i]);
+        else if (arg == "--bowsers" && hasValue)
+            recipe.bowsers = atoi(argv[++i]);
+        else if (arg == "--boos" && hasValue)
+            recipe.boos = atoi(argv[++i]);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (count < 1 || jobs < 1 || (outDir.empty() && !bench && count != 1))
+    {
+        usage();
+        return 1;
+    }
+    // Too sparse a grid never connects enough squares to hold everything
+    if (recipe.paths < 0.3 || recipe.paths > 1 || recipe.bowsers < 0 || recipe.boos < 0 ||
+        recipe.redCoins + recipe.stars + recipe.banks + recipe.events + recipe.arrows > 0.8)
+    {
+        cerr << "boardgen: --paths must be from 0.3 to 1, enemy counts can't be negative, and the\n"
+             << "square fractions can't add up to more than 0.8" << endl;
+        return 1;
+    }
+    if (!outDir.empty() && outDir.back() != '/')
+        outDir.push_back('/');
+
+    // Workers claim boards in turn; board n always comes from seed S+n-1
+    atomic<int> next(1);
+    atomic<long long> rejected(0);
+    atomic<bool> failed(false);
+    auto worker = [&]()
+    {
+        Board board;
+        for (int n; !failed && (n = next++) <= count; )
+        {
+            BoardGenerator generator(seed + n - 1);
+            bool made = generator.generate(recipe, board);
+            rejected += generator.rejected();
+            if (!made)
+            {
+                cerr << "No layout fits the recipe for board " << n << endl;
+                failed = true;
+                break;
+            }
+            if (bench)
+                continue;
+            if (outDir.empty())
+                cout << board.toText();
+            else
+            {
+                string path = outDir + "board" + to_string(n) + ".txt";
+                ofstream boardFile(path);
+                if (!boardFile || !(boardFile << board.toText()))
+                {
+                    cerr << "Cannot write " << path << endl;
+                    failed = true;
+                }
+            }
+        }
+    };
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int j = 1; j < min(jobs, count); j++)
+        workers.emplace_back(worker);
+    worker();
+    for (thread& t : workers)
+        t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (failed)
+        return 1;
+
+    if (bench || !outDir.empty())
+    {
+        cerr << "generated " << count << " board" << (count == 1 ? "" : "s") << " in " << seconds * 1000
+             << " ms (" << static_cast<long long>(count / seconds) << " boards/s, "
+             << rejected.load() << " layouts redrawn)" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+// hashdiff: compares two action logs recorded by peachsim --record-actions
+// with --hash-every, e.g. from two builds, two --jobs settings or --macro
+// against tick by tick play.
+//
+//   hashdiff a.log b.log
+//
+// Walks the state hashes both logs recorded and reports the first tick at
+// which they differ, the last one at which they agreed, and which actors
+// (or the squares and bank) differ there, along with the first action the
+// two runs consumed differently.  Exits with 0 if the runs agree at every
+// tick both recorded, 1 if they diverge and 2 if a log can't be read.
+
+#include "StateHash.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+using namespace std;
+
+static void usage()
+{
+    cerr << "usage: hashdiff a.log b.log" << endl;
+}
+
+// The action lines of a log, in file order
+static bool readActions(const string& path, vector<string>& actions)
+{
+    ifstream in(path);
+    if (!in)
+        return false;
+    string line;
+    while (getline(in, line))
+        if (!line.empty() && line[0] != '#')
+            actions.push_back(line);
+    return true;
+}
+
+static string describe(const ActorState& actor)
+{
+    ostringstream oss;
+    oss << "at " << actor.x << "," << actor.y;
+    if (actor.coins >= 0)
+        oss << " with " << actor.coins << " coins, " << actor.stars << " stars";
+    return oss.str();
+}
+
+// Prints how the actors in two snapshots of the same tick differ
+static void compareActors(const WorldState& a, const WorldState& b)
+{
+    map<string, const ActorState*> inB;
+    for (const ActorState& actor : b.actors)
+        inB[actor.name] = &actor;
+    for (const ActorState& actor : a.actors)
+    {
+        auto other = inB.find(actor.name);
+        if (other == inB.end())
+            cout << "  " << actor.name << " only in the first run, " << describe(actor) << "\n";
+        else
+        {
+            if (other->second->hash != actor.hash)
+            {
+                string first = describe(actor);
+                string second = describe(*other->second);
+                cout << "  " << actor.name << " " << first << " vs " << second;
+                if (first == second)
+                    cout << " (hashes differ)";
+                cout << "\n";
+            }
+            inB.erase(other);
+        }
+    }
+    for (const auto& actor : inB)
+        cout << "  " << actor.first << " only in the second run, " << describe(*actor.second) << "\n";
+    if (a.board != b.board)
+        cout << "  squares or bank differ\n";
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        usage();
+        return 2;
+    }
+    vector<WorldState> states[2];
+    vector<string> actions[2];
+    for (int r = 0; r < 2; r++)
+    {
+        if (!readWorldStates(argv[r + 1], states[r]) || !readActions(argv[r + 1], actions[r]))
+        {
+            cerr << "Cannot read " << argv[r + 1] << endl;
+            return 2;
+        }
+        if (states[r].empty())
+        {
+            cerr << argv[r + 1] << " has no state hashes; record it with --hash-every" << endl;
+            return 2;
+        }
+    }
+
+    // Snapshots are compared where both runs took one
+    size_t i = 0, j = 0;
+    long long compared = 0;
+    long long agreedAt = -1;
+    const WorldState* divergedA = nullptr;
+    const WorldState* divergedB = nullptr;
+    while (i < states[0].size() && j < states[1].size())
+    {
+        const WorldState& a = states[0][i];
+        const WorldState& b = states[1][j];
+        if (a.tick < b.tick)
+            i++;
+        else if (b.tick < a.tick)
+            j++;
+        else
+        {
+            compared++;
+            if (a.hash != b.hash)
+            {
+                divergedA = &a;
+                divergedB = &b;
+                break;
+            }
+            agreedAt = a.tick;
+            i++;
+            j++;
+        }
+    }
+
+    size_t action = 0;
+    while (action < actions[0].size() && action < actions[1].size() && actions[0][action] == actions[1][action])
+        action++;
+    bool actionsDiffer = (action < actions[0].size() || action < actions[1].size());
+
+    if (divergedA == nullptr)
+    {
+        if (compared == 0)
+        {
+            cerr << "The logs have no ticks in common" << endl;
+            return 2;
+        }
+        cout << "Runs agree at all " << compared << " ticks compared (last " << agreedAt << ")";
+        if (states[0].back().tick != states[1].back().tick)
+            cout << "; the first ends at tick " << states[0].back().tick << " and the second at "
+                 << states[1].back().tick;
+        cout << endl;
+        if (actionsDiffer)
+            cout << "Consumed actions differ from action " << action + 1 << endl;
+        return (actionsDiffer || states[0].back().tick != states[1].back().tick) ? 1 : 0;
+    }
+
+    cout << "Runs diverge by tick " << divergedA->tick;
+    if (agreedAt >= 0)
+        cout << " (they agreed at tick " << agreedAt << ")";
+    else
+        cout << " (the first tick compared)";
+    cout << "\n";
+    compareActors(*divergedA, *divergedB);
+    if (actionsDiffer)
+    {
+        cout << "Consumed actions first differ at action " << action + 1 << ": "
+             << (action < actions[0].size() ? actions[0][action] : "(none)") << " vs "
+             << (action < actions[1].size() ? actions[1][action] : "(none)") << "\n";
+    }
+    cout << flush;
+    return 1;
+}
@@ -0,0 +1,140 @@
+// landingtable: exact landing probabilities for a board, computed from its
+// layout rather than by playing games.
+//
+//   landingtable [options] [assetDir]
+//     --board N          board number 1-9 (default 1)
+//     --policy P         how players choose at forks: uniform (default) or straight
+//     --from X,Y         only the square at board cell (X, Y)
+//     --dir D            only players walking right, up, left or down
+//     --passes           expected number of times each cell is walked over,
+//                        rather than landing probabilities
+//
+// Prints one CSV line per reachable cell:  from_x,from_y,dir,to_x,to_y,value
+
+#include "LandingAnalysis.h"
+#include "Board.h"
+#include "GraphObject.h"
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+using namespace std;
+
+static const char* const DIR_NAMES[4] = { "right", "up", "left", "down" };
+
+static void usage()
+{
+    cerr << "usage: landingtable [--board N] [--policy uniform|straight] [--from X,Y]\n"
+         << "                    [--dir right|up|left|down] [--passes] [assetDir]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    string assetPath = "Assets";
+    int board = 1;
+    ForkPolicy policy = fork_uniform;
+    int fromX = -1, fromY = -1;
+    int onlyDir = -1;
+    bool passes = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--board" && hasValue)
+            board = atoi(argv[++i]);
+        else if (arg == "--policy" && hasValue)
+        {
+            string name = argv[++i];
+            if (name == "uniform")
+                policy = fork_uniform;
+            else if (name == "straight")
+                policy = fork_straight;
+            else
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if (arg == "--from" && hasValue)
+        {
+            if (sscanf(argv[++i], "%d,%d", &fromX, &fromY) != 2)
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if (arg == "--dir" && hasValue)
+        {
+            string name = argv[++i];
+            for (int d = 0; d < 4; d++)
+                if (name == DIR_NAMES[d])
+                    onlyDir = d * 90;
+            if (onlyDir < 0)
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if (arg == "--passes")
+            passes = true;
+        else if (!arg.empty() && arg[0] != '-')
+            assetPath = arg;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (board < 1 || board > 9)
+    {
+        usage();
+        return 1;
+    }
+    if (assetPath.back() != '/')
+        assetPath.push_back('/');
+
+    ostringstream oss;
+    oss << assetPath << "board0" << board << ".txt";
+    Board bd;
+    if (bd.loadBoard(oss.str()) != Board::load_success)
+    {
+        cerr << "Cannot load " << oss.str() << endl;
+        return 1;
+    }
+
+    unique_ptr<LandingAnalysis> analysis(new LandingAnalysis);
+    analysis->analyze(bd);
+
+    if (fromX >= 0 && !analysis->isSquare(LandingAnalysis::cellOf(fromX, fromY)))
+    {
+        cerr << "No square at " << fromX << "," << fromY << endl;
+        return 1;
+    }
+
+    cout << "from_x,from_y,dir,to_x,to_y," << (passes ? "passes" : "probability") << "\n";
+    for (int cell : analysis->squares())
+    {
+        int x = LandingAnalysis::xOf(cell);
+        int y = LandingAnalysis::yOf(cell);
+        if (fromX >= 0 && (x != fromX || y != fromY))
+            continue;
+        for (int d = 0; d < 4; d++)
+        {
+            int dir = d * 90;
+            if (onlyDir >= 0 && dir != onlyDir)
+                continue;
+            vector<double> dist = passes ? analysis->passDistribution(cell, dir, policy)
+                                         : analysis->landingDistribution(cell, dir, policy);
+            for (size_t to = 0; to < dist.size(); to++)
+            {
+                if (dist[to] > 0)
+                    cout << x << "," << y << "," << DIR_NAMES[d] << ","
+                         << LandingAnalysis::xOf(static_cast<int>(to)) << "," << LandingAnalysis::yOf(static_cast<int>(to))
+                         << "," << dist[to] << "\n";
+            }
+        }
+    }
+}
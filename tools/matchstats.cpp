@@ -0,0 +1,127 @@
+// matchstats: sums up match logs written by peachsim --results.
+//
+//   matchstats [options] log...
+//     --csv FILE         also export every record as CSV ("-" for stdout)
+//     --jobs N           read N logs at a time on worker threads (default:
+//                        one per core)
+//
+// Prints the number of games, wins by seat, each bot's win rate and average
+// stars and coins, and how often each square effect fired per game, then
+// how many records a second were read.  Exits with 1 if a log can't be
+// read.
+
+#include "MatchLog.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+using namespace std;
+
+static void usage()
+{
+    cerr << "usage: matchstats [--csv FILE] [--jobs N] log..." << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    string csvPath;
+    int jobs = static_cast<int>(thread::hardware_concurrency());
+    vector<string> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--csv" && i + 1 < argc)
+            csvPath = argv[++i];
+        else if (arg == "--jobs" && i + 1 < argc)
+            jobs = atoi(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-')
+            paths.push_back(arg);
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (paths.empty() || jobs < 0)
+    {
+        usage();
+        return 2;
+    }
+    jobs = max(1, min(jobs, static_cast<int>(paths.size())));
+
+    // Each worker sums the logs it claims; the sums are merged at the end
+    auto start = chrono::steady_clock::now();
+    vector<MatchSummary> summaries(jobs);
+    atomic<size_t> next(0);
+    atomic<bool> failed(false);
+    auto worker = [&](MatchSummary& summary)
+    {
+        for (size_t f; (f = next++) < paths.size(); )
+        {
+            MatchReader reader;
+            MatchColumns columns;
+            if (!reader.open(paths[f]))
+            {
+                failed = true;
+                continue;
+            }
+            while (reader.nextBlock(columns))
+                summary.add(columns);
+            if (reader.failed())
+                failed = true;
+        }
+    };
+    vector<thread> workers;
+    for (int j = 1; j < jobs; j++)
+        workers.emplace_back(worker, ref(summaries[j]));
+    worker(summaries[0]);
+    for (thread& t : workers)
+        t.join();
+    for (int j = 1; j < jobs; j++)
+        summaries[0].merge(summaries[j]);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    const MatchSummary& total = summaries[0];
+
+    total.print(cout);
+    cerr << "read " << total.games << " records from " << paths.size() << " log" << (paths.size() == 1 ? "" : "s")
+         << " in " << seconds * 1000 << " ms (" << static_cast<long long>(total.games / max(seconds, 1e-9))
+         << " records/s)" << endl;
+
+    // The export goes in file order, after the summary has found how many
+    // seats to name
+    if (!csvPath.empty())
+    {
+        ofstream csvFile;
+        if (csvPath != "-")
+        {
+            csvFile.open(csvPath);
+            if (!csvFile)
+            {
+                cerr << "Cannot create " << csvPath << endl;
+                return 1;
+            }
+        }
+        ostream& out = (csvPath == "-") ? cout : csvFile;
+        writeMatchCsvHeading(out, total.maxPlayers);
+        for (const string& path : paths)
+        {
+            MatchReader reader;
+            MatchColumns columns;
+            if (!reader.open(path))
+                continue;
+            while (reader.nextBlock(columns))
+                writeMatchCsv(columns, out);
+        }
+        if (!out.flush())
+        {
+            cerr << "Cannot write " << csvPath << endl;
+            return 1;
+        }
+    }
+    return failed ? 1 : 0;
+}
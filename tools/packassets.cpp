@@ -0,0 +1,100 @@
+// packassets: bundles the game's assets into one indexed file, so that
+// starting the game opens and maps a single file and decodes nothing.
+//
+//   packassets [--out FILE] [assetDir]
+//     --out FILE         where to write the pack (default Assets.pak)
+//
+// Every sprite and sound in AssetManifest.h is stored decoded: sprites as
+// RGBA with their mipmap chains, sounds as 16-bit stereo at the mixer's
+// rate.  The boards (board01.txt to board09.txt) are stored as they are.
+// PeachParty uses Assets.pak when run without arguments if it exists, and
+// PeachParty or peachsim use any pack named on the command line.  Rebuild
+// the pack whenever Assets/ changes.
+
+#include "AssetPack.h"
+#include "AssetManifest.h"
+#include "AudioMixer.h"
+#include "MappedFile.h"
+#include "TgaDecoder.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+static void usage()
+{
+    cerr << "usage: packassets [--out FILE] [assetDir]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    string assetPath = "Assets";
+    string outPath = "Assets.pak";
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc)
+            outPath = argv[++i];
+        else if (!arg.empty() && arg[0] != '-')
+            assetPath = arg;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (assetPath.back() != '/')
+        assetPath.push_back('/');
+
+    auto start = chrono::steady_clock::now();
+    AssetPackWriter writer;
+    for (const auto& d : SPRITE_ASSETS)
+    {
+        TgaImage image;
+        if (!loadTga(assetPath + d.tgaFileName, image))
+            return 1;
+        writer.addSprite(d.tgaFileName, image);
+    }
+    // The game plays on without a sound it can't load, so leave it out
+    int numSounds = 0;
+    for (const auto& sound : SOUND_ASSETS)
+    {
+        vector<short> frames;
+        if (!decodeWavFile(assetPath + sound.wavFileName, AudioMixer::SAMPLE_RATE, frames))
+        {
+            cerr << "warning: cannot decode " << assetPath + sound.wavFileName << "; leaving it out" << endl;
+            continue;
+        }
+        writer.addSound(sound.wavFileName, frames, AudioMixer::SAMPLE_RATE);
+        numSounds++;
+    }
+    int numBoards = 0;
+    for (int n = 1; n <= 9; n++)
+    {
+        string name = "board0" + to_string(n) + ".txt";
+        MappedFile board;
+        if (!board.open(assetPath + name))
+            continue;
+        writer.addFile(name, board.data(), board.size());
+        numBoards++;
+    }
+
+    string error;
+    if (!writer.write(outPath, error))
+    {
+        cerr << error << endl;
+        return 1;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Read it back, as the game would
+    AssetPack pack;
+    MappedFile written;
+    if (!pack.open(outPath) || !written.open(outPath))
+        return 1;
+    cerr << "packed " << (sizeof(SPRITE_ASSETS) / sizeof(SPRITE_ASSETS[0])) << " sprites, "
+         << numSounds << " sounds and " << numBoards << " boards into "
+         << outPath << " (" << written.size() / 1024 << " KB) in " << seconds * 1000 << " ms" << endl;
+    return 0;
+}
@@ -0,0 +1,663 @@
+// peachsim: plays Peach Party matches between bots without opening a window.
+//
+//   peachsim [options] [assetDir | pack.pak]
+//     --board N          board number 1-9 (default 1)
+//     --random-boards    play each game on a fresh board generated from its
+//                        seed (see boardgen) instead of --board
+//     --games N          number of matches to play (default 1)
+//     --seed S           seed the random number generator; game N is played
+//                        with seed S+N-1, so results don't depend on --jobs
+//     --jobs N           play N games at a time on worker threads; can't be
+//                        combined with capture, audio, sound logs or replays
+//     --p1 BOT, --p2 BOT bot names: random, idle (default random)
+//     --players N        players per game, 2 to 64 (default 2)
+//     --others BOT       bot for players 3 and up (default random)
+//     --capture PATH     record frames; PATH ending in .y4m writes a video,
+//                        anything else is used as a PPM file name prefix
+//     --capture-every N  capture one frame every N ticks (default 1)
+//     --scale N          capture at N times the 256x256 board resolution
+//     --capture-drop     drop frames rather than wait when the encoder lags
+//     --sound-log FILE   write a "tick,sound" line for every sound event
+//     --audio-out FILE   mix the match's sounds into a .wav file
+//     --sound-window N   coalesce repeats of a sound within N ticks
+//     --heatmap FILE     write per-square visit and effect counts for all games
+//     --results FILE     append a record of every game to a columnar match log
+//                        (read it with matchstats)
+//     --economy-log FILE record every coin, star and bank transaction; FILE
+//                        ending in .csv is written as CSV, anything else as
+//                        binary EconomyEvents (FILE.N for game N when
+//                        playing several games)
+//     --record-actions FILE  save every consumed action as "tick,player,action"
+//                        (FILE.N for game N when playing several games)
+//     --hash-every N     also save the world's state hash, and each actor's
+//                        share of it, every N ticks and at the end (compare
+//                        runs with hashdiff)
+//     --replay FILE      feed a recorded action log back in; players it names
+//                        take their actions from it instead of a bot
+//     --script FILE      like --replay, for hand-written test scripts
+//     --macro            let walking movers cover a square per update instead
+//                        of 2 pixels per tick; results are unchanged
+//     --skip-quiet       jump the clock over ticks in which no actor would act
+//                        and no input is due; results are unchanged
+//     --verify-fast      play every game tick by tick and with the speedups
+//                        above (both if neither is given), check they end
+//                        identically and compare the work done
+//     --metrics-socket PATH  serve live counters (ticks a second, matches,
+//                        actors alive, vortices, allocations, move() time)
+//                        as text on a Unix domain socket
+//     --metrics-dump FILE  write the counters to FILE on SIGUSR1 and at exit
+
+#include "StudentWorld.h"
+#include "Actor.h"
+#include "Bot.h"
+#include "FrameEncoder.h"
+#include "SoftwareRenderer.h"
+#include "AudioMixer.h"
+#include "AssetManifest.h"
+#include "AssetPack.h"
+#include "SoundBus.h"
+#include "InputPipeline.h"
+#include "Heatmap.h"
+#include "MatchLog.h"
+#include "EconomyLog.h"
+#include "BoardGenerator.h"
+#include "Metrics.h"
+#include "StateHash.h"
+#include "GameConstants.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <climits>
+using namespace std;
+
+static const int MS_PER_SIM_TICK = 10;
+
+// Plays the world's sounds into an offline mixer that advances with the tick clock
+class MixerSoundListener : public SoundListener
+{
+public:
+    MixerSoundListener(AudioMixer& mixer) : m_mixer(mixer) {}
+    virtual void onSound(const SoundEvent& event)
+    {
+        m_mixer.play(event.soundID);
+    }
+private:
+    AudioMixer& m_mixer;
+};
+
+static void usage()
+{
+    cerr << "usage: peachsim [--board N] [--random-boards] [--games N] [--seed S] [--jobs N] [--p1 BOT] [--p2 BOT]\n"
+         << "                [--players N] [--others BOT]\n"
+         << "                [--capture PATH] [--capture-every N] [--scale N] [--capture-drop]\n"
+         << "                [--sound-log FILE] [--audio-out FILE] [--sound-window N]\n"
+         << "                [--heatmap FILE] [--results FILE] [--economy-log FILE] [--record-actions FILE]\n"
+         << "                [--hash-every N]\n"
+         << "                [--replay FILE] [--script FILE] [--macro] [--skip-quiet] [--verify-fast]\n"
+         << "                [--metrics-socket PATH] [--metrics-dump FILE]\n"
+         << "                [assetDir | pack.pak]" << endl;
+}
+
+static bool endsWith(const string& s, const string& suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Options and the outputs shared by every game of a run
+struct Sim
+{
+    string assetPath = "Assets";
+    AssetPack pack;             // used instead of assetPath if open
+    int board = 1;
+    bool randomBoards = false;
+    int games = 1;
+    int jobs = 1;
+    string p1 = "random";
+    string p2 = "random";
+    string others = "random";
+    int players = 2;
+    unsigned int seed = random_device()();
+    int captureEvery = 1;
+    int soundWindow = 0;
+    int hashEvery = 0;
+    string soundLogPath;
+    string recordActionsPath;
+    string economyLogPath;
+    string heatmapPath;
+    bool macro = false;
+    bool skipQuiet = false;
+    bool verifyFast = false;
+    atomic<long long> tickUpdates{0};     // --verify-fast totals
+    atomic<long long> fastUpdates{0};
+    atomic<long long> tickSteps{0};
+    atomic<long long> fastSteps{0};
+    atomic<int> mismatches{0};
+
+    unique_ptr<ActionScript> script;
+    unique_ptr<SoftwareRenderer> renderer;
+    FrameEncoder encoder;
+    unique_ptr<AudioMixer> mixer;
+    unique_ptr<MixerSoundListener> mixerListener;
+    MatchWriter results;        // if --results was given
+    bool recordResults = false;
+};
+
+// How a game ended in more detail than its result line, for comparing runs
+struct GameStats
+{
+    string finalState;
+    long long actorUpdates;
+    long long worldSteps;     // calls to move()
+};
+
+// Plays one game and describes its outcome in result; false if the board
+// couldn't be loaded.  Square statistics are added to heatmap if given, the
+// final state to stats and the outcome to record.
+static bool playGame(Sim& sim, int game, bool macro, bool skipQuiet, SquareHeatmap* heatmap, string& result,
+                     GameStats* stats, MatchRecord* record)
+{
+    unsigned int gameSeed = sim.seed + game - 1;
+    seedRandInt(gameSeed);
+    vector<unique_ptr<Bot>> bots;
+    for (int playerNum = 1; playerNum <= sim.players; playerNum++)
+    {
+        const string& name = (playerNum == 1) ? sim.p1 : (playerNum == 2) ? sim.p2 : sim.others;
+        bots.emplace_back(createBot(name, gameSeed + playerNum));
+    }
+    const int framesPerTick = AudioMixer::SAMPLE_RATE * MS_PER_SIM_TICK / 1000;
+    vector<GraphObject*> sprites;
+
+    StudentWorld world(sim.assetPath);
+    world.setBoardNumber(sim.board);
+    if (sim.pack.isOpen())
+        world.setAssetPack(&sim.pack);
+    Board generatedBoard;
+    if (sim.randomBoards)
+    {
+        BoardGenerator generator(gameSeed);
+        if (!generator.generate(BoardRecipe(), generatedBoard))
+        {
+            result = "Could not generate a board for game " + to_string(game);
+            return false;
+        }
+        world.setBoard(&generatedBoard);
+    }
+    world.setNumPlayers(sim.players);
+    world.useTickClock(MS_PER_SIM_TICK);
+    world.soundBus().setCoalesceWindow(sim.soundWindow);
+    SoundRecorder recorder;
+    if (!sim.soundLogPath.empty() || stats != nullptr)
+        world.soundBus().subscribe(&recorder);
+    world.setMacroStepping(macro);
+    if (sim.mixerListener)
+        world.soundBus().subscribe(sim.mixerListener.get());
+    ActionLog actionLog;
+    if (!sim.recordActionsPath.empty())
+        world.setActionLog(&actionLog);
+    EconomyLog economyLog;
+    string economyPath = (sim.games > 1) ? sim.economyLogPath + "." + to_string(game) : sim.economyLogPath;
+    bool economyCsv = endsWith(sim.economyLogPath, ".csv");
+    if (!sim.economyLogPath.empty())
+    {
+        if (!economyCsv && !economyLog.spillTo(economyPath))
+            cerr << "Cannot write " << economyPath << endl;
+        world.setEconomyLog(&economyLog);
+    }
+    world.setHeatmap(heatmap);
+    if (sim.script)
+        sim.script->rewind();
+    if (world.init() != GWSTATUS_CONTINUE_GAME)
+    {
+        result = "Could not start a game on board " + to_string(sim.board);
+        return false;
+    }
+
+    int status;
+    long long worldSteps = 0;
+    do
+    {
+        // Skip ahead only if no bot is about to act; scripted input bounds
+        // the jump
+        if (skipQuiet)
+        {
+            bool waiting = true;
+            for (int playerNum = 1; playerNum <= sim.players && waiting; playerNum++)
+            {
+                if (!sim.script || !sim.script->controlsPlayer(playerNum))
+                    waiting = bots[playerNum-1]->isWaiting(&world, playerNum);
+            }
+            long long limit = (sim.script && sim.script->nextTick() >= 0) ? sim.script->nextTick() : LLONG_MAX;
+            if (sim.hashEvery > 0)
+                limit = min(limit, (world.getTickCount() / sim.hashEvery + 1) * sim.hashEvery);
+            long long skipped = waiting ? world.skipQuietTicks(limit) : 0;
+            if (sim.mixer && skipped > 0)
+                sim.mixer->render(static_cast<int>(framesPerTick * skipped));
+        }
+        if (sim.script)
+            sim.script->feed(world);
+        for (int playerNum = 1; playerNum <= sim.players; playerNum++)
+        {
+            if (!sim.script || !sim.script->controlsPlayer(playerNum))
+                bots[playerNum-1]->act(&world, playerNum);
+        }
+        status = world.move();
+        worldSteps++;
+        if (sim.hashEvery > 0 && (world.getTickCount() % sim.hashEvery == 0 || status != GWSTATUS_CONTINUE_GAME))
+        {
+            WorldState state;
+            ostringstream lines;
+            world.wakeCoastingMovers();
+            world.getWorldState(state);
+            writeWorldState(lines, state);
+            actionLog.recordComment(state.tick, lines.str());
+        }
+        if (sim.mixer)
+            sim.mixer->render(framesPerTick);
+        if (sim.renderer && world.getTickCount() % sim.captureEvery == 0)
+        {
+            world.wakeCoastingMovers();
+            world.getSprites(sprites);
+            sim.renderer->renderGraphObjects(sprites);
+            sim.encoder.submitFrame(sim.renderer->pixels());
+        }
+    } while (status == GWSTATUS_CONTINUE_GAME);
+
+    ostringstream oss;
+    oss << "Game " << game << ": ";
+    if (status == GWSTATUS_PLAYER_WON)
+        oss << "PLAYER " << world.getWinner() << " WON!";
+    else
+        oss << (status == GWSTATUS_PEACH_WON ? "PEACH" : "YOSHI") << " WON!";
+    oss << " STARS: " << world.getWinnerStars() << " COINS: " << world.getWinnerCoins()
+        << " TICKS: " << world.getTickCount();
+    result = oss.str();
+    if (record != nullptr)
+    {
+        world.wakeCoastingMovers();
+        record->game = game;
+        record->board = sim.randomBoards ? 0 : sim.board;
+        record->seed = gameSeed;
+        record->winner = world.getWinner();
+        record->bank = world.getBank();
+        record->ticks = world.getTickCount();
+        record->numPlayers = world.getNumPlayers();
+        for (int playerNum = 1; playerNum <= record->numPlayers; playerNum++)
+        {
+            const string& name = (playerNum == 1) ? sim.p1 : (playerNum == 2) ? sim.p2 : sim.others;
+            Player* player = world.getPlayer(playerNum);
+            record->bots[playerNum-1] = botIndex(name);
+            record->stars[playerNum-1] = player->getStars();
+            record->coins[playerNum-1] = player->getCoins();
+        }
+        for (int e = 0; e < NUM_HEAT_EVENTS; e++)
+            record->events[e] = world.getEventCount(static_cast<HeatEvent>(e));
+    }
+    if (stats != nullptr)
+    {
+        world.wakeCoastingMovers();
+        ostringstream state;
+        state << "hash " << hex << world.getStateHash() << dec << " bank " << world.getBank();
+        for (int playerNum = 1; playerNum <= world.getNumPlayers(); playerNum++)
+        {
+            Player* player = world.getPlayer(playerNum);
+            state << " | " << player->getStars() << " " << player->getCoins() << " " << player->hasVortex()
+                  << " at " << player->getX() << "," << player->getY() << " " << player->isWalking()
+                  << " " << player->getWalkDir() << " " << player->getTicks();
+        }
+        for (const SoundEvent& event : recorder.events())
+            state << " " << event.tick << ":" << event.soundID;
+        stats->finalState = state.str();
+        stats->actorUpdates = world.getActorUpdates();
+        stats->worldSteps = worldSteps;
+    }
+    if (!sim.soundLogPath.empty() && !recorder.save(sim.soundLogPath, game > 1))
+        cerr << "Cannot write " << sim.soundLogPath << endl;
+    if (!sim.recordActionsPath.empty())
+    {
+        string path = (sim.games > 1) ? sim.recordActionsPath + "." + to_string(game) : sim.recordActionsPath;
+        if (!actionLog.save(path))
+            cerr << "Cannot write " << path << endl;
+    }
+    if (!sim.economyLogPath.empty())
+    {
+        ofstream csvFile;
+        if (economyCsv)
+        {
+            csvFile.open(economyPath);
+            economyLog.writeCsv(csvFile);
+        }
+        if (economyCsv ? !csvFile : !economyLog.flush())
+            cerr << "Cannot write " << economyPath << endl;
+    }
+    world.cleanUp();
+    return true;
+}
+
+// Plays game as the options say.  With --verify-fast it is played tick by
+// tick and then with the speedups, and a difference is added to result.
+static bool runGame(Sim& sim, int game, SquareHeatmap* heatmap, string& result)
+{
+    MatchRecord record;
+    MatchRecord* recordPtr = sim.recordResults ? &record : nullptr;
+    if (!sim.verifyFast)
+    {
+        if (!playGame(sim, game, sim.macro, sim.skipQuiet, heatmap, result, nullptr, recordPtr))
+            return false;
+        if (recordPtr != nullptr)
+            sim.results.add(record);
+        Metrics::add(metric_matches);
+        return true;
+    }
+
+    bool macro = sim.macro || !sim.skipQuiet;
+    bool skipQuiet = sim.skipQuiet || !sim.macro;
+    GameStats tickStats, fastStats;
+    string fastResult;
+    if (!playGame(sim, game, false, false, heatmap, result, &tickStats, recordPtr) ||
+        !playGame(sim, game, macro, skipQuiet, nullptr, fastResult, &fastStats, nullptr))
+        return false;
+    if (recordPtr != nullptr)
+        sim.results.add(record);
+    Metrics::add(metric_matches);
+    sim.tickUpdates += tickStats.actorUpdates;
+    sim.fastUpdates += fastStats.actorUpdates;
+    sim.tickSteps += tickStats.worldSteps;
+    sim.fastSteps += fastStats.worldSteps;
+    if (fastResult != result || fastStats.finalState != tickStats.finalState)
+    {
+        sim.mismatches++;
+        result += "  FAST RUN DIFFERS: " + fastResult;
+    }
+    return true;
+}
+
+static void printReduction(const char* what, long long before, long long after)
+{
+    cout << what << " " << before << " tick by tick, " << after << " fast";
+    if (after > 0)
+        cout << " (" << fixed << setprecision(1) << double(before) / after << "x fewer)";
+}
+
+int main(int argc, char* argv[])
+{
+    Sim sim;
+    string capturePath;
+    int scale = 1;
+    bool captureDrop = false;
+    string audioOutPath;
+    string resultsPath;
+    string scriptPath;
+    int scriptSource = source_replay;
+    string metricsSocketPath;
+    string metricsDumpPath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--board" && hasValue)
+            sim.board = atoi(argv[++i]);
+        else if (arg == "--games" && hasValue)
+            sim.games = atoi(argv[++i]);
+        else if (arg == "--jobs" && hasValue)
+            sim.jobs = atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue)
+            sim.seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--p1" && hasValue)
+            sim.p1 = argv[++i];
+        else if (arg == "--p2" && hasValue)
+            sim.p2 = argv[++i];
+        else if (arg == "--others" && hasValue)
+            sim.others = argv[++i];
+        else if (arg == "--players" && hasValue)
+            sim.players = atoi(argv[++i]);
+        else if (arg == "--capture" && hasValue)
+            capturePath = argv[++i];
+        else if (arg == "--capture-every" && hasValue)
+            sim.captureEvery = atoi(argv[++i]);
+        else if (arg == "--scale" && hasValue)
+            scale = atoi(argv[++i]);
+        else if (arg == "--capture-drop")
+            captureDrop = true;
+        else if (arg == "--sound-log" && hasValue)
+            sim.soundLogPath = argv[++i];
+        else if (arg == "--audio-out" && hasValue)
+            audioOutPath = argv[++i];
+        else if (arg == "--sound-window" && hasValue)
+            sim.soundWindow = atoi(argv[++i]);
+        else if (arg == "--heatmap" && hasValue)
+            sim.heatmapPath = argv[++i];
+        else if (arg == "--results" && hasValue)
+            resultsPath = argv[++i];
+        else if (arg == "--economy-log" && hasValue)
+            sim.economyLogPath = argv[++i];
+        else if (arg == "--record-actions" && hasValue)
+            sim.recordActionsPath = argv[++i];
+        else if (arg == "--hash-every" && hasValue)
+            sim.hashEvery = atoi(argv[++i]);
+        else if ((arg == "--replay" || arg == "--script") && hasValue)
+        {
+            scriptSource = (arg == "--replay") ? source_replay : source_script;
+            scriptPath = argv[++i];
+        }
+        else if (arg == "--macro")
+            sim.macro = true;
+        else if (arg == "--skip-quiet")
+            sim.skipQuiet = true;
+        else if (arg == "--verify-fast")
+            sim.verifyFast = true;
+        else if (arg == "--random-boards")
+            sim.randomBoards = true;
+        else if (arg == "--metrics-socket" && hasValue)
+            metricsSocketPath = argv[++i];
+        else if (arg == "--metrics-dump" && hasValue)
+            metricsDumpPath = argv[++i];
+        else if (!arg.empty() && arg[0] != '-')
+            sim.assetPath = arg;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (sim.board < 1 || sim.board > 9 || sim.games < 1 || sim.jobs < 1 ||
+        sim.players < 2 || sim.players > MAX_PLAYERS || sim.captureEvery < 1 || sim.hashEvery < 0)
+    {
+        usage();
+        return 1;
+    }
+    if (sim.hashEvery > 0 && sim.recordActionsPath.empty())
+    {
+        cerr << "--hash-every needs --record-actions" << endl;
+        return 1;
+    }
+    if (sim.jobs > 1 && (!capturePath.empty() || !audioOutPath.empty() || !sim.soundLogPath.empty() || !scriptPath.empty()))
+    {
+        cerr << "--jobs can't be combined with capture, audio, sound logs or replays" << endl;
+        return 1;
+    }
+    if (sim.verifyFast && (!capturePath.empty() || !audioOutPath.empty() || !sim.soundLogPath.empty() ||
+                           !sim.recordActionsPath.empty() || !sim.economyLogPath.empty()))
+    {
+        cerr << "--verify-fast can't be combined with capture, audio, sound logs or recording" << endl;
+        return 1;
+    }
+    if (sim.skipQuiet && !capturePath.empty())
+    {
+        cerr << "--skip-quiet can't be combined with capture" << endl;
+        return 1;
+    }
+    if (endsWith(sim.assetPath, ".pak"))
+    {
+        if (!sim.pack.open(sim.assetPath))
+        {
+            cerr << "Cannot open asset pack " << sim.assetPath << endl;
+            return 1;
+        }
+    }
+    else if (sim.assetPath.back() != '/')
+        sim.assetPath.push_back('/');
+
+    unique_ptr<Bot> probe[3] = { unique_ptr<Bot>(createBot(sim.p1, 0)), unique_ptr<Bot>(createBot(sim.p2, 0)),
+                                 unique_ptr<Bot>(createBot(sim.others, 0)) };
+    if (probe[0] == nullptr || probe[1] == nullptr || probe[2] == nullptr)
+    {
+        cerr << "Unknown bot name" << endl;
+        return 1;
+    }
+
+    if (!scriptPath.empty())
+    {
+        sim.script.reset(new ActionScript(scriptSource));
+        if (!sim.script->load(scriptPath))
+        {
+            cerr << "Cannot read actions from " << scriptPath << endl;
+            return 1;
+        }
+    }
+
+    if (!capturePath.empty())
+    {
+        sim.renderer.reset(new SoftwareRenderer(scale));
+        if (!(sim.pack.isOpen() ? sim.renderer->loadAllSprites(sim.pack) : sim.renderer->loadAllSprites(sim.assetPath)))
+            return 1;
+        FrameEncoder::Format format = endsWith(capturePath, ".y4m") ? FrameEncoder::y4m_video : FrameEncoder::ppm_sequence;
+        int fps = 1000 / MS_PER_SIM_TICK / sim.captureEvery;
+        if (!sim.encoder.open(capturePath, format, sim.renderer->width(), sim.renderer->height(), (fps < 1) ? 1 : fps,
+                              32, !captureDrop))
+            return 1;
+    }
+
+    if (!audioOutPath.empty())
+    {
+        sim.mixer.reset(new AudioMixer);
+        WavFileAudioDevice* wav = new WavFileAudioDevice(AudioMixer::SAMPLE_RATE, false);
+        if (!wav->open(audioOutPath))
+        {
+            cerr << "Cannot create " << audioOutPath << endl;
+            delete wav;
+            return 1;
+        }
+        sim.mixer->setDevice(wav);
+        for (const auto& sound : SOUND_ASSETS)
+        {
+            AssetPack::Sound clip;
+            if (!sim.pack.isOpen())
+                sim.mixer->loadClip(sound.soundID, sim.assetPath + sound.wavFileName);
+            else if (sim.pack.findSound(sound.wavFileName, clip) && clip.sampleRate == AudioMixer::SAMPLE_RATE)
+                sim.mixer->useClip(sound.soundID, clip.stereoFrames, clip.numFrames);
+        }
+        sim.mixerListener.reset(new MixerSoundListener(*sim.mixer));
+    }
+
+    if (!resultsPath.empty())
+    {
+        if (!sim.results.open(resultsPath))
+        {
+            cerr << "Cannot create " << resultsPath << endl;
+            return 1;
+        }
+        sim.recordResults = true;
+    }
+
+    MetricsExporter metrics;
+    if ((!metricsSocketPath.empty() && !metrics.serve(metricsSocketPath)) ||
+        (!metricsDumpPath.empty() && !metrics.dumpOnSignal(metricsDumpPath)))
+        return 1;
+
+    // Each worker counts into its own heatmap; they're merged at the end
+    int numWorkers = min(sim.jobs, sim.games);
+    vector<unique_ptr<SquareHeatmap>> heatmaps(numWorkers);
+    if (!sim.heatmapPath.empty())
+    {
+        for (auto& heatmap : heatmaps)
+            heatmap.reset(new SquareHeatmap);
+    }
+
+    if (sim.jobs == 1)
+    {
+        for (int game = 1; game <= sim.games; game++)
+        {
+            string result;
+            bool ok = runGame(sim, game, heatmaps[0].get(), result);
+            (ok ? cout : cerr) << result << endl;
+            if (!ok)
+                return 1;
+        }
+    }
+    else
+    {
+        // Workers claim games in turn; results are printed in game order
+        vector<string> results(sim.games + 1);
+        atomic<int> nextGame(1);
+        atomic<bool> failed(false);
+        vector<thread> workers;
+        for (int j = 0; j < numWorkers; j++)
+        {
+            SquareHeatmap* heatmap = heatmaps[j].get();
+            workers.emplace_back([&, heatmap]() {
+                int game;
+                while (!failed && (game = nextGame++) <= sim.games)
+                {
+                    if (!runGame(sim, game, heatmap, results[game]))
+                        failed = true;
+                }
+            });
+        }
+        for (thread& worker : workers)
+            worker.join();
+        for (int game = 1; game <= sim.games; game++)
+            if (!results[game].empty())
+                cout << results[game] << endl;
+        if (failed)
+            return 1;
+    }
+
+    if (!sim.heatmapPath.empty())
+    {
+        for (int j = 1; j < numWorkers; j++)
+            heatmaps[0]->merge(*heatmaps[j]);
+        ostringstream comment;
+        comment << "board " << sim.board << ", " << sim.games << " games";
+        if (!heatmaps[0]->save(sim.heatmapPath, comment.str()))
+            cerr << "Cannot write " << sim.heatmapPath << endl;
+    }
+
+    if (!metricsDumpPath.empty() && !metrics.dump(metricsDumpPath))
+        cerr << "Cannot write " << metricsDumpPath << endl;
+
+    if (sim.recordResults && !sim.results.close())
+    {
+        cerr << "Cannot write " << resultsPath << endl;
+        return 1;
+    }
+
+    if (sim.verifyFast)
+    {
+        cout << "Fast runs matched " << (sim.games - sim.mismatches) << " of " << sim.games << " games; ";
+        printReduction("actor updates", sim.tickUpdates, sim.fastUpdates);
+        cout << "; ";
+        printReduction("world steps", sim.tickSteps, sim.fastSteps);
+        cout << endl;
+        if (sim.mismatches > 0)
+            return 1;
+    }
+
+    if (sim.renderer)
+    {
+        sim.encoder.close();
+        cout << "Captured " << sim.encoder.framesWritten() << " frames";
+        if (sim.encoder.framesDropped() > 0)
+            cout << " (" << sim.encoder.framesDropped() << " dropped)";
+        cout << endl;
+    }
+}